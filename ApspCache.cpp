@@ -0,0 +1,171 @@
+#include "ApspCache.h"
+#include "FloydWarshall.h"
+
+ApspCache::ApspCache()
+{
+    m_Version = 0;
+    for (int i = 0; i < 2; i++)
+    {
+        m_Matrix[i].valid = false;
+        m_Matrix[i].version = 0;
+        m_Matrix[i].negativeCycle = false;
+        m_Matrix[i].size = 0;
+    }
+    m_Sums.valid = false;
+    m_Sums.version = 0;
+    m_Sums.negativeCycle = false;
+}
+
+int ApspCache::slot(char option)
+{
+    return option == 'O' ? 0 : 1;
+}
+
+bool ApspCache::fresh(bool valid, unsigned version)
+{
+    return valid && version == m_Version;
+}
+
+void ApspCache::invalidate()
+{
+    lock_guard<mutex> guard(m_Lock);
+    m_Version++;
+
+    // Release memory held by stale results
+    for (int i = 0; i < 2; i++)
+    {
+        m_Matrix[i].valid = false;
+        vector<int>().swap(m_Matrix[i].dist);
+    }
+    m_Sums.valid = false;
+    vector<DistanceSum>().swap(m_Sums.rows);
+}
+
+unsigned ApspCache::version()
+{
+    lock_guard<mutex> guard(m_Lock);
+    return m_Version;
+}
+
+const vector<int> *ApspCache::matrix(Graph *graph, char option)
+{
+    MatrixEntry &entry = m_Matrix[slot(option)];
+    unsigned version;
+    {
+        lock_guard<mutex> guard(m_Lock);
+        if (fresh(entry.valid, entry.version))
+            return entry.negativeCycle ? nullptr : &entry.dist;
+        version = m_Version;
+    }
+
+    // Computed without the lock: blockedFloyd waits for defaultPool(), whose jobs may
+    // themselves be waiting in lookup()
+    vector<int> dist;
+    bool negativeCycle = !blockedFloyd(graph, option, dist);
+
+    lock_guard<mutex> guard(m_Lock);
+    // The first result for this version wins, a published matrix is never replaced
+    if (version == m_Version && !fresh(entry.valid, entry.version))
+    {
+        entry.dist.swap(dist);
+        entry.negativeCycle = negativeCycle;
+        entry.size = graph->getSize();
+        entry.version = version;
+        entry.valid = true;
+    }
+    if (!fresh(entry.valid, entry.version))
+    {
+        // The graph changed meanwhile, nothing to hand out
+        return nullptr;
+    }
+    return entry.negativeCycle ? nullptr : &entry.dist;
+}
+
+const vector<DistanceSum> *ApspCache::distanceSums(Graph *graph)
+{
+    unsigned version;
+    const vector<int> *full = nullptr;
+    int n = 0;
+    {
+        lock_guard<mutex> guard(m_Lock);
+        if (fresh(m_Sums.valid, m_Sums.version))
+            return m_Sums.negativeCycle ? nullptr : &m_Sums.rows;
+        version = m_Version;
+
+        // A cached undirected matrix is summed below, outside the lock. Published
+        // entries stay put until invalidate(), which never overlaps a query.
+        const MatrixEntry &entry = m_Matrix[slot('X')];
+        if (fresh(entry.valid, entry.version))
+        {
+            if (entry.negativeCycle)
+            {
+                m_Sums.negativeCycle = true;
+                m_Sums.rows.clear();
+                m_Sums.version = version;
+                m_Sums.valid = true;
+                return nullptr;
+            }
+            full = &entry.dist;
+            n = entry.size;
+        }
+    }
+
+    vector<DistanceSum> rows;
+    bool negativeCycle = false;
+    if (full)
+    {
+        // Row sums of the cached undirected matrix
+        rows.assign(n, DistanceSum());
+        for (int i = 0; i < n; i++)
+        {
+            DistanceSum row = {0, true};
+            for (int j = 0; j < n; j++)
+            {
+                int d = (*full)[(size_t)i * n + j];
+                if (i == j)
+                    continue;
+                if (d == INF)
+                {
+                    row.reachAll = false;
+                    break;
+                }
+                row.sum += d;
+            }
+            rows[i] = row;
+        }
+    }
+    else
+    {
+        negativeCycle = !allSourceDistanceSums(graph, 'X', rows);
+    }
+
+    lock_guard<mutex> guard(m_Lock);
+    if (version == m_Version && !fresh(m_Sums.valid, m_Sums.version))
+    {
+        m_Sums.rows.swap(rows);
+        m_Sums.negativeCycle = negativeCycle;
+        m_Sums.version = version;
+        m_Sums.valid = true;
+    }
+    if (!fresh(m_Sums.valid, m_Sums.version))
+    {
+        return nullptr;
+    }
+    return m_Sums.negativeCycle ? nullptr : &m_Sums.rows;
+}
+
+bool ApspCache::lookup(char option, int from, int to, int &dist)
+{
+    lock_guard<mutex> guard(m_Lock);
+    const MatrixEntry &entry = m_Matrix[slot(option)];
+
+    if (!fresh(entry.valid, entry.version) || entry.negativeCycle)
+        return false;
+
+    int n = entry.size;
+    if (from < 0 || from >= n || to < 0 || to >= n)
+        return false;
+
+    dist = entry.dist[(size_t)from * n + to];
+    return true;
+}
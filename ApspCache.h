@@ -0,0 +1,58 @@
+#ifndef _APSPCACHE_H_
+#define _APSPCACHE_H_
+
+#include "Graph.h"
+#include "ShortestPath.h"
+#include <mutex>
+
+// All-pairs shortest path results shared by FLOYD and CENTRALITY.
+// Entries are tagged with the graph version they were computed for;
+// invalidate() must be called whenever the loaded graph changes.
+// Results are computed outside m_Lock and published once, so lookup() never
+// waits for a running Floyd and the lock is never held around defaultPool().
+class ApspCache
+{
+private:
+	struct MatrixEntry
+	{
+		bool valid;
+		unsigned version;
+		bool negativeCycle;
+		int size;
+		vector<int> dist;	// size x size row-major, INF when unreachable
+	};
+
+	struct SumEntry
+	{
+		bool valid;
+		unsigned version;
+		bool negativeCycle;
+		vector<DistanceSum> rows;
+	};
+
+	MatrixEntry m_Matrix[2];	// [0] directed ('O'), [1] undirected
+	SumEntry m_Sums;			// Undirected per-source distance sums
+	unsigned m_Version;
+	mutex m_Lock;
+
+	static int slot(char option);
+	bool fresh(bool valid, unsigned version);
+
+public:
+	ApspCache();
+
+	void invalidate();	// Drop every entry and move to a new graph version
+	unsigned version();
+
+	// n x n distance matrix for option, computed on first use. nullptr on negative cycle.
+	const vector<int> *matrix(Graph *graph, char option);
+
+	// Undirected distance sums for CENTRALITY, taken from a cached undirected
+	// matrix when one exists. nullptr on negative cycle.
+	const vector<DistanceSum> *distanceSums(Graph *graph);
+
+	// Single pair distance from an already cached matrix, false when not cached
+	bool lookup(char option, int from, int to, int &dist);
+};
+
+#endif
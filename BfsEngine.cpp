@@ -0,0 +1,256 @@
+#include "BfsEngine.h"
+#include "ThreadPool.h"
+#include "Stats.h"
+#include <climits>
+
+// Beamer's switching thresholds
+static const int BFS_ALPHA = 14;    // Go bottom-up when frontier edges > unexplored edges / ALPHA
+static const int BFS_BETA = 24;     // Go back top-down when frontier < n / BETA
+
+// Edges a vertex expands in the view, undirected views use out + in as an upper bound
+static long long viewDegree(Graph *graph, char option, int v)
+{
+    return option == 'O' ? graph->outDegree(v) : graph->outDegree(v) + graph->inDegree(v);
+}
+
+static long long reverseDegree(Graph *graph, char option, int v)
+{
+    return option == 'O' ? graph->inDegree(v) : graph->outDegree(v) + graph->inDegree(v);
+}
+
+// Work split sizes for one parallel step
+static const int LIST_CHUNK = 1024;    // Frontier vertices per task
+static const int WORD_CHUNK = 64;      // Bitmap words per task
+
+void bfsLevels(Graph *graph, char option, int source, vector<int> &level)
+{
+    int n = graph->getSize();
+    ThreadPool &pool = defaultPool();
+    int threads = pool.size();
+
+    Bitmap visited, frontierBits, nextBits;
+    visited.reset(n);
+    frontierBits.reset(n);
+    nextBits.reset(n);
+    vector<int> frontier(1, source);
+    vector<vector<int>> local(threads);            // Next frontier found by each thread
+    vector<long long> localEdges(threads), localCount(threads);
+
+    level.assign(n, -1);
+    level[source] = 0;
+    visited.set(source);
+
+    long long unexplored = 0;
+    for (int v = 0; v < n; v++)
+        unexplored += viewDegree(graph, option, v);
+
+    long long frontierCount = 1;
+    long long frontierEdges = viewDegree(graph, option, source);
+    unexplored -= frontierEdges;
+    bool bottomUp = false;
+
+    for (int depth = 0; frontierCount > 0; depth++)
+    {
+        // Pick direction for this level, converting the frontier representation
+        if (!bottomUp && frontierEdges > unexplored / BFS_ALPHA)
+        {
+            bottomUp = true;
+            frontierBits.clear();
+            for (int u : frontier)
+                frontierBits.set(u);
+        }
+        else if (bottomUp && frontierCount < n / BFS_BETA)
+        {
+            bottomUp = false;
+            frontier.clear();
+            for (int wi = 0; wi < frontierBits.words(); wi++)
+            {
+                for (unsigned long long bits = frontierBits.word(wi); bits; bits &= bits - 1)
+                    frontier.push_back(wi * 64 + __builtin_ctzll(bits));
+            }
+        }
+
+        fill(localEdges.begin(), localEdges.end(), 0);
+        fill(localCount.begin(), localCount.end(), 0);
+
+        if (!bottomUp)
+        {
+            // Top-down: threads split the frontier list and race to claim children
+            int tasks = ((int)frontier.size() + LIST_CHUNK - 1) / LIST_CHUNK;
+            pool.parallelFor(tasks, [&](int task, int worker)
+            {
+                int end = min((int)frontier.size(), (task + 1) * LIST_CHUNK);
+                for (int i = task * LIST_CHUNK; i < end; i++)
+                {
+                    forEachEdge(graph, frontier[i], option, [&](int v, int)
+                    {
+                        STAT_ADD(STAT_RELAXED, 1);
+                        if (visited.claim(v))
+                        {
+                            STAT_ADD(STAT_SETTLED, 1);
+                            level[v] = depth + 1;
+                            local[worker].push_back(v);
+                            localEdges[worker] += viewDegree(graph, option, v);
+                        }
+                        return true;
+                    });
+                }
+            });
+
+            // Concatenate per-thread buffers into the next frontier
+            frontier.clear();
+            for (int t = 0; t < threads; t++)
+            {
+                localCount[t] = (long long)local[t].size();
+                frontier.insert(frontier.end(), local[t].begin(), local[t].end());
+                local[t].clear();
+            }
+        }
+        else
+        {
+            // Bottom-up: each thread owns a range of bitmap words, so no atomics are needed
+            nextBits.clear();
+            int words = visited.words();
+            int tasks = (words + WORD_CHUNK - 1) / WORD_CHUNK;
+            pool.parallelFor(tasks, [&](int task, int worker)
+            {
+                int end = min(words, (task + 1) * WORD_CHUNK);
+                for (int wi = task * WORD_CHUNK; wi < end; wi++)
+                {
+                    unsigned long long bits = ~visited.word(wi);
+                    if (wi == words - 1 && n % 64)
+                        bits &= (1ULL << (n % 64)) - 1;
+
+                    for (; bits; bits &= bits - 1)
+                    {
+                        int v = wi * 64 + __builtin_ctzll(bits);
+                        // Any parent in the frontier will do
+                        forEachReverseEdge(graph, v, option, [&](int u, int)
+                        {
+                            STAT_ADD(STAT_RELAXED, 1);
+                            if (!frontierBits.test(u))
+                                return true;
+                            STAT_ADD(STAT_SETTLED, 1);
+                            visited.set(v);
+                            nextBits.set(v);
+                            level[v] = depth + 1;
+                            localCount[worker]++;
+                            localEdges[worker] += viewDegree(graph, option, v);
+                            return false;
+                        });
+                    }
+                }
+            });
+            frontierBits.swap(nextBits);
+        }
+
+        frontierCount = frontierEdges = 0;
+        for (int t = 0; t < threads; t++)
+        {
+            frontierCount += localCount[t];
+            frontierEdges += localEdges[t];
+        }
+        unexplored -= frontierEdges;
+    }
+}
+
+void directionOptimizingBfs(Graph *graph, char option, int source, vector<int> &order)
+{
+    int n = graph->getSize();
+    ThreadPool &pool = defaultPool();
+    int threads = pool.size();
+    vector<int> level;
+    bfsLevels(graph, option, source, level);
+
+    // Bucket reached vertices by level, ascending id inside each bucket
+    int depth = 0;
+    for (int v = 0; v < n; v++)
+        depth = max(depth, level[v] + 1);
+    vector<int> start(depth + 1, 0), byLevel;
+    for (int v = 0; v < n; v++)
+    {
+        if (level[v] >= 0)
+            start[level[v] + 1]++;
+    }
+    for (int d = 0; d < depth; d++)
+        start[d + 1] += start[d];
+    byLevel.resize(start[depth]);
+    vector<int> fillPos(start.begin(), start.end() - 1);
+    for (int v = 0; v < n; v++)
+    {
+        if (level[v] >= 0)
+            byLevel[fillPos[level[v]]++] = v;
+    }
+
+    // Queue BFS appends level d + 1 sorted by (position of earliest parent in level d, id)
+    vector<int> pos(n, -1), parentRank(n, INT_MAX), count;
+    order.clear();
+    order.push_back(source);
+    pos[source] = 0;
+
+    for (int d = 0; d + 1 < depth; d++)
+    {
+        int curBegin = start[d], curEnd = start[d + 1];
+        int nextBegin = start[d + 1], nextEnd = start[d + 2];
+
+        // Rebuild from whichever side touches fewer edges, the bottom side runs in parallel
+        long long topCost = 0, bottomCost = 0;
+        for (int i = curBegin; i < curEnd; i++)
+            topCost += viewDegree(graph, option, order[i]);
+        for (int i = nextBegin; i < nextEnd; i++)
+            bottomCost += reverseDegree(graph, option, byLevel[i]);
+        bottomCost /= threads;
+
+        if (topCost <= bottomCost)
+        {
+            // Replay the queue: parents in order, children ascending
+            for (int i = curBegin; i < curEnd; i++)
+            {
+                forEachEdge(graph, order[i], option, [&](int v, int)
+                {
+                    if (level[v] == d + 1 && pos[v] < 0)
+                    {
+                        pos[v] = (int)order.size();
+                        order.push_back(v);
+                    }
+                    return true;
+                });
+            }
+        }
+        else
+        {
+            // Earliest parent of each child, then a stable counting sort on it
+            int width = curEnd - curBegin;
+            int tasks = (nextEnd - nextBegin + LIST_CHUNK - 1) / LIST_CHUNK;
+            pool.parallelFor(tasks, [&](int task, int)
+            {
+                int end = min(nextEnd, nextBegin + (task + 1) * LIST_CHUNK);
+                for (int i = nextBegin + task * LIST_CHUNK; i < end; i++)
+                {
+                    int v = byLevel[i];
+                    forEachReverseEdge(graph, v, option, [&](int u, int)
+                    {
+                        if (level[u] == d)
+                            parentRank[v] = min(parentRank[v], pos[u] - curBegin);
+                        return true;
+                    });
+                }
+            });
+
+            count.assign(width + 1, 0);
+            for (int i = nextBegin; i < nextEnd; i++)
+                count[parentRank[byLevel[i]] + 1]++;
+            for (int r = 0; r < width; r++)
+                count[r + 1] += count[r];
+
+            order.resize(nextEnd);
+            for (int i = nextBegin; i < nextEnd; i++)
+            {
+                int v = byLevel[i];
+                int slot = nextBegin + count[parentRank[v]]++;
+                order[slot] = v;
+                pos[v] = slot;
+            }
+        }
+    }
+}
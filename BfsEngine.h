@@ -0,0 +1,45 @@
+#ifndef _BFSENGINE_H_
+#define _BFSENGINE_H_
+
+#include "Graph.h"
+
+// Fixed-size set of vertex ids, one bit each
+class Bitmap
+{
+private:
+	vector<unsigned long long> m_Words;
+
+public:
+	void reset(int size) { m_Words.assign((size + 63) / 64, 0ULL); }
+	void clear() { fill(m_Words.begin(), m_Words.end(), 0ULL); }
+	bool test(int v) const { return (m_Words[v >> 6] >> (v & 63)) & 1ULL; }
+	void set(int v) { m_Words[v >> 6] |= 1ULL << (v & 63); }
+
+	// Thread-safe set, true only for the one caller that flipped the bit
+	bool claim(int v)
+	{
+		unsigned long long bit = 1ULL << (v & 63);
+		if (__atomic_load_n(&m_Words[v >> 6], __ATOMIC_RELAXED) & bit)
+			return false;
+		return !(__atomic_fetch_or(&m_Words[v >> 6], bit, __ATOMIC_RELAXED) & bit);
+	}
+
+	int words() const { return (int)m_Words.size(); }
+	unsigned long long word(int i) const { return m_Words[i]; }
+	void swap(Bitmap &other) { m_Words.swap(other.m_Words); }
+};
+
+// Hop level of every vertex from source (-1 when unreachable).
+// Each level is expanded on defaultPool(): top-down steps split the frontier list,
+// claim vertices with an atomic bit and collect them in per-thread buffers;
+// bottom-up steps split the bitmap words between threads.
+void bfsLevels(Graph *graph, char option, int source, vector<int> &level);
+
+// BFS visit order from source, identical to the queue-based BFS that expands
+// neighbors in ascending order. Levels come from a direction-optimizing search
+// (top-down / bottom-up switching on frontier edge counts over bitmap frontiers),
+// the within-level order is rebuilt afterwards from each vertex's earliest parent,
+// so the result does not depend on the thread count.
+void directionOptimizingBfs(Graph *graph, char option, int source, vector<int> &order);
+
+#endif
@@ -0,0 +1,517 @@
+#include "CsrGraph.h"
+#include "GraphLoader.h"
+#include <iostream>
+#include <utility>
+#include <algorithm>
+
+// Patched rows are folded back once they hold this many entries, or edges / COMPACT_SHARE
+static const long long COMPACT_MIN_SLOTS = 1 << 16;
+static const int COMPACT_SHARE = 4;
+
+CsrGraph::CsrGraph(bool type, int size) : Graph(type, size)
+{
+    m_File = nullptr;
+    m_PatchedSlots = 0;
+    m_EdgeDelta = 0;
+
+    // Create empty rows
+    m_OffsetData.assign(size + 1, 0);
+    m_InOffsetData.assign(size + 1, 0);
+    bindOwned();
+}
+
+CsrGraph::CsrGraph(Graph *source) : Graph(source->getType(), source->getSize())
+{
+    m_File = nullptr;
+    m_PatchedSlots = 0;
+    m_EdgeDelta = 0;
+    m_OffsetData.assign(m_Size + 1, 0);
+
+    // Copy outgoing edges row by row (map keeps each row sorted by destination)
+    for (int u = 0; u < m_Size; u++)
+    {
+        map<int, int> adj;
+        source->getAdjacentEdgesDirect(u, &adj);
+
+        for (auto &p : adj)
+        {
+            m_TargetData.push_back(p.first);
+            m_WeightData.push_back(p.second);
+        }
+        m_OffsetData[u + 1] = (int)m_TargetData.size();
+    }
+
+    buildIncoming();
+}
+
+CsrGraph::CsrGraph(bool type, int size, const vector<int> &from, const vector<int> &to, const vector<int> &weight) : Graph(type, size)
+{
+    m_File = nullptr;
+    m_PatchedSlots = 0;
+    m_EdgeDelta = 0;
+    int edges = (int)from.size();
+
+    // Bucket edge indices by source, indices stay ascending inside a bucket
+    vector<int> start(m_Size + 1, 0);
+    for (int e = 0; e < edges; e++)
+    {
+        start[from[e] + 1]++;
+    }
+    for (int v = 0; v < m_Size; v++)
+    {
+        start[v + 1] += start[v];
+    }
+    vector<int> order(edges);
+    vector<int> pos(start.begin(), start.end() - 1);
+    for (int e = 0; e < edges; e++)
+    {
+        order[pos[from[e]]++] = e;
+    }
+
+    m_OffsetData.assign(m_Size + 1, 0);
+    m_TargetData.reserve(edges);
+    m_WeightData.reserve(edges);
+
+    for (int u = 0; u < m_Size; u++)
+    {
+        // Sort the row by destination, later insertions last among equal destinations
+        stable_sort(order.begin() + start[u], order.begin() + start[u + 1], [&](int a, int b)
+        {
+            return to[a] < to[b];
+        });
+
+        for (int i = start[u]; i < start[u + 1]; i++)
+        {
+            int e = order[i];
+            if (i + 1 < start[u + 1] && to[order[i + 1]] == to[e])
+                continue;
+            m_TargetData.push_back(to[e]);
+            m_WeightData.push_back(weight[e]);
+        }
+        m_OffsetData[u + 1] = (int)m_TargetData.size();
+    }
+
+    buildIncoming();
+}
+
+CsrGraph::CsrGraph(bool type, int size, int edges, const int *arrays, MappedFile *file) : Graph(type, size)
+{
+    m_File = file;
+    m_PatchedSlots = 0;
+    m_EdgeDelta = 0;
+
+    // Arrays sit back to back in the snapshot
+    m_Offset = arrays;
+    m_Target = m_Offset + size + 1;
+    m_Weight = m_Target + edges;
+    m_InOffset = m_Weight + edges;
+    m_InSource = m_InOffset + size + 1;
+    m_InWeight = m_InSource + edges;
+}
+
+CsrGraph::~CsrGraph()
+{
+    delete m_File;
+}
+
+void CsrGraph::bindOwned()
+{
+    m_Offset = m_OffsetData.data();
+    m_Target = m_TargetData.data();
+    m_Weight = m_WeightData.data();
+    m_InOffset = m_InOffsetData.data();
+    m_InSource = m_InSourceData.data();
+    m_InWeight = m_InWeightData.data();
+}
+
+int CsrGraph::edgeCount()
+{
+    return m_Offset[m_Size] + m_EdgeDelta;
+}
+
+void CsrGraph::outRow(int vertex, const int *&ends, const int *&weights, int &count)
+{
+    if (!m_OutPatch.empty() && m_OutPatch[vertex] >= 0)
+    {
+        const Row &row = m_Rows[m_OutPatch[vertex]];
+        ends = row.ends.data();
+        weights = row.weights.data();
+        count = (int)row.ends.size();
+        return;
+    }
+    ends = m_Target + m_Offset[vertex];
+    weights = m_Weight + m_Offset[vertex];
+    count = m_Offset[vertex + 1] - m_Offset[vertex];
+}
+
+void CsrGraph::inRow(int vertex, const int *&ends, const int *&weights, int &count)
+{
+    if (!m_InPatch.empty() && m_InPatch[vertex] >= 0)
+    {
+        const Row &row = m_Rows[m_InPatch[vertex]];
+        ends = row.ends.data();
+        weights = row.weights.data();
+        count = (int)row.ends.size();
+        return;
+    }
+    ends = m_InSource + m_InOffset[vertex];
+    weights = m_InWeight + m_InOffset[vertex];
+    count = m_InOffset[vertex + 1] - m_InOffset[vertex];
+}
+
+int CsrGraph::patchRow(bool incoming, int vertex)
+{
+    vector<int> &index = incoming ? m_InPatch : m_OutPatch;
+    if (index.empty())
+    {
+        index.assign(m_Size, -1);
+    }
+
+    // First change of this row copies it out of the arrays
+    if (index[vertex] < 0)
+    {
+        const int *ends, *weights;
+        int count;
+        if (incoming)
+            inRow(vertex, ends, weights, count);
+        else
+            outRow(vertex, ends, weights, count);
+
+        m_Rows.push_back(Row());
+        m_Rows.back().ends.assign(ends, ends + count);
+        m_Rows.back().weights.assign(weights, weights + count);
+        m_PatchedSlots += count;
+        index[vertex] = (int)m_Rows.size() - 1;
+    }
+    return index[vertex];
+}
+
+void CsrGraph::compact() // Rebuild flat owned arrays from the current rows
+{
+    vector<int> offset(m_Size + 1, 0), target, weight;
+    vector<int> inOffset(m_Size + 1, 0), source, inWeight;
+    int edges = edgeCount();
+    target.reserve(edges);
+    weight.reserve(edges);
+    source.reserve(edges);
+    inWeight.reserve(edges);
+
+    const int *ends, *weights;
+    int count;
+    for (int v = 0; v < m_Size; v++)
+    {
+        outRow(v, ends, weights, count);
+        target.insert(target.end(), ends, ends + count);
+        weight.insert(weight.end(), weights, weights + count);
+        offset[v + 1] = (int)target.size();
+
+        inRow(v, ends, weights, count);
+        source.insert(source.end(), ends, ends + count);
+        inWeight.insert(inWeight.end(), weights, weights + count);
+        inOffset[v + 1] = (int)source.size();
+    }
+
+    m_OffsetData.swap(offset);
+    m_TargetData.swap(target);
+    m_WeightData.swap(weight);
+    m_InOffsetData.swap(inOffset);
+    m_InSourceData.swap(source);
+    m_InWeightData.swap(inWeight);
+    bindOwned();
+
+    vector<int>().swap(m_OutPatch);
+    vector<int>().swap(m_InPatch);
+    vector<Row>().swap(m_Rows);
+    m_PatchedSlots = 0;
+    m_EdgeDelta = 0;
+
+    // A mapped snapshot is no longer referenced
+    delete m_File;
+    m_File = nullptr;
+}
+
+void CsrGraph::buildIncoming() // Build reverse CSR from outgoing rows
+{
+    int edges = (int)m_TargetData.size();
+
+    m_InOffsetData.assign(m_Size + 1, 0);
+    m_InSourceData.resize(edges);
+    m_InWeightData.resize(edges);
+
+    // Count in-degree of each vertex
+    for (int e = 0; e < edges; e++)
+    {
+        m_InOffsetData[m_TargetData[e] + 1]++;
+    }
+    for (int v = 0; v < m_Size; v++)
+    {
+        m_InOffsetData[v + 1] += m_InOffsetData[v];
+    }
+
+    // Scatter edges, sources are visited in ascending order so each row stays sorted
+    vector<int> pos(m_InOffsetData.begin(), m_InOffsetData.end() - 1);
+    for (int u = 0; u < m_Size; u++)
+    {
+        for (int e = m_OffsetData[u]; e < m_OffsetData[u + 1]; e++)
+        {
+            int slot = pos[m_TargetData[e]]++;
+            m_InSourceData[slot] = u;
+            m_InWeightData[slot] = m_WeightData[e];
+        }
+    }
+
+    bindOwned();
+}
+
+void CsrGraph::getAdjacentEdges(int vertex, map<int, int> *m) // Definition of getAdjacentEdges(No Direction == Undirected)
+{
+    const int *ends, *weights;
+    int count;
+
+    // Add outgoing edges
+    outRow(vertex, ends, weights, count);
+    for (int e = 0; e < count; e++)
+    {
+        (*m)[ends[e]] = weights[e];
+    }
+
+    // Add incoming edges to treat the graph as undirected
+    inRow(vertex, ends, weights, count);
+    for (int e = 0; e < count; e++)
+    {
+        (*m)[ends[e]] = weights[e];
+    }
+}
+
+void CsrGraph::getAdjacentEdgesDirect(int vertex, map<int, int> *m) // Definition of getAdjacentEdges(Directed graph)
+{
+    const int *ends, *weights;
+    int count;
+
+    // Add outgoing edges
+    outRow(vertex, ends, weights, count);
+    for (int e = 0; e < count; e++)
+    {
+        (*m)[ends[e]] = weights[e];
+    }
+}
+
+void CsrGraph::insertEdge(int from, int to, int weight) // Definition of insertEdge
+{
+    // Only the two rows involved change, the arrays stay as they are
+    int outIndex = patchRow(false, from);
+    int inIndex = patchRow(true, to);
+    Row &out = m_Rows[outIndex];
+    Row &in = m_Rows[inIndex];
+
+    // Both rows are sorted, so the edge has one slot in each direction
+    int pos = (int)(lower_bound(out.ends.begin(), out.ends.end(), to) - out.ends.begin());
+    int inPos = (int)(lower_bound(in.ends.begin(), in.ends.end(), from) - in.ends.begin());
+
+    // Overwrite weight if the edge already exists
+    if (pos < (int)out.ends.size() && out.ends[pos] == to)
+    {
+        out.weights[pos] = weight;
+        in.weights[inPos] = weight;
+        return;
+    }
+
+    out.ends.insert(out.ends.begin() + pos, to);
+    out.weights.insert(out.weights.begin() + pos, weight);
+    in.ends.insert(in.ends.begin() + inPos, from);
+    in.weights.insert(in.weights.begin() + inPos, weight);
+    m_PatchedSlots += 2;
+    m_EdgeDelta++;
+
+    if (m_PatchedSlots > max(COMPACT_MIN_SLOTS, (long long)edgeCount() / COMPACT_SHARE))
+    {
+        compact();
+    }
+}
+
+bool CsrGraph::removeEdge(int from, int to) // Definition of removeEdge
+{
+    const int *ends, *weights;
+    int count;
+
+    outRow(from, ends, weights, count);
+    if (!binary_search(ends, ends + count, to))
+    {
+        return false;
+    }
+
+    // The incoming row must hold the same edge
+    inRow(to, ends, weights, count);
+    if (!binary_search(ends, ends + count, from))
+    {
+        return false;
+    }
+
+    int outIndex = patchRow(false, from);
+    int inIndex = patchRow(true, to);
+    Row &out = m_Rows[outIndex];
+    Row &in = m_Rows[inIndex];
+
+    // Close the gap in both directions
+    int pos = (int)(lower_bound(out.ends.begin(), out.ends.end(), to) - out.ends.begin());
+    out.ends.erase(out.ends.begin() + pos);
+    out.weights.erase(out.weights.begin() + pos);
+    int inPos = (int)(lower_bound(in.ends.begin(), in.ends.end(), from) - in.ends.begin());
+    in.ends.erase(in.ends.begin() + inPos);
+    in.weights.erase(in.weights.begin() + inPos);
+    m_PatchedSlots -= 2;
+    m_EdgeDelta--;
+
+    if (m_PatchedSlots > max(COMPACT_MIN_SLOTS, (long long)edgeCount() / COMPACT_SHARE))
+    {
+        compact();
+    }
+    return true;
+}
+
+bool CsrGraph::printGraph(LogSink *fout) // Definition of print Graph
+{
+    if (!fout || !fout->is_open())
+    {
+        return false;
+    }
+
+    // List type prints adjacency list
+    if (m_Type)
+    {
+        for (int i = 0; i < m_Size; i++)
+        {
+            (*fout) << "[" << i << "]";
+
+            const int *ends, *weights;
+            int count;
+            outRow(i, ends, weights, count);
+            if (count == 0)
+            {
+                (*fout) << " ->" << "\n";
+                continue;
+            }
+
+            for (int e = 0; e < count; e++)
+            {
+                (*fout) << " -> (" << ends[e] << "," << weights[e] << ")";
+            }
+
+            (*fout) << "\n";
+        }
+        return true;
+    }
+
+    // Matrix type prints full matrix
+    (*fout) << "    ";
+    for (int j = 0; j < m_Size; j++)
+        (*fout) << "[" << j << "] ";
+    (*fout) << "\n";
+
+    for (int i = 0; i < m_Size; i++)
+    {
+        (*fout) << "[" << i << "] ";
+        const int *ends, *weights;
+        int count;
+        outRow(i, ends, weights, count);
+        int e = 0;
+        for (int j = 0; j < m_Size; j++)
+        {
+            // Row is sorted, so walk it alongside the column index
+            int weight = 0;
+            if (e < count && ends[e] == j)
+            {
+                weight = weights[e++];
+            }
+            (*fout) << weight << "   ";
+        }
+        (*fout) << "\n";
+    }
+    return true;
+}
+
+void CsrGraph::forEachOutEdge(int vertex, EdgeVisitor &visitor)
+{
+    const int *ends, *weights;
+    int count;
+    outRow(vertex, ends, weights, count);
+    for (int e = 0; e < count; e++)
+    {
+        if (!visitor.visit(ends[e], weights[e]))
+            return;
+    }
+}
+
+void CsrGraph::forEachInEdge(int vertex, EdgeVisitor &visitor)
+{
+    const int *ends, *weights;
+    int count;
+    inRow(vertex, ends, weights, count);
+    for (int e = 0; e < count; e++)
+    {
+        if (!visitor.visit(ends[e], weights[e]))
+            return;
+    }
+}
+
+void CsrGraph::mergeAdjacent(int vertex, bool inWins, EdgeVisitor &visitor)
+{
+    // Merge sorted out/in rows, inWins picks which weight a two-way pair reports
+    const int *target, *weight, *source, *inWeight;
+    int outEnd, inEnd;
+    outRow(vertex, target, weight, outEnd);
+    inRow(vertex, source, inWeight, inEnd);
+    int out = 0, in = 0;
+
+    while (out < outEnd || in < inEnd)
+    {
+        bool keep;
+        if (in == inEnd || (out < outEnd && target[out] < source[in]))
+        {
+            keep = visitor.visit(target[out], weight[out]);
+            out++;
+        }
+        else if (out == outEnd || source[in] < target[out])
+        {
+            keep = visitor.visit(source[in], inWeight[in]);
+            in++;
+        }
+        else
+        {
+            keep = visitor.visit(source[in], inWins ? inWeight[in] : weight[out]);
+            out++;
+            in++;
+        }
+
+        if (!keep)
+            return;
+    }
+}
+
+void CsrGraph::forEachAdjacentEdge(int vertex, EdgeVisitor &visitor)
+{
+    // Incoming weight wins on a tie like getAdjacentEdges
+    mergeAdjacent(vertex, true, visitor);
+}
+
+void CsrGraph::forEachReverseAdjacentEdge(int vertex, EdgeVisitor &visitor)
+{
+    // Neighbor u sees vertex with u's outgoing weight when it exists
+    mergeAdjacent(vertex, false, visitor);
+}
+
+int CsrGraph::outDegree(int vertex)
+{
+    const int *ends, *weights;
+    int count;
+    outRow(vertex, ends, weights, count);
+    return count;
+}
+
+int CsrGraph::inDegree(int vertex)
+{
+    const int *ends, *weights;
+    int count;
+    inRow(vertex, ends, weights, count);
+    return count;
+}
@@ -0,0 +1,79 @@
+#ifndef _CSR_H_
+#define _CSR_H_
+
+#include "Graph.h"
+
+class MappedFile;
+
+class CsrGraph : public Graph
+{
+private:
+	// Outgoing edges of vertex v are m_Target/m_Weight[m_Offset[v] .. m_Offset[v + 1])
+	const int *m_Offset;
+	const int *m_Target;
+	const int *m_Weight;
+
+	// Incoming edges of vertex v are m_InSource/m_InWeight[m_InOffset[v] .. m_InOffset[v + 1])
+	const int *m_InOffset;
+	const int *m_InSource;
+	const int *m_InWeight;
+
+	// Storage behind the arrays above unless they point into m_File
+	vector<int> m_OffsetData;
+	vector<int> m_TargetData;
+	vector<int> m_WeightData;
+	vector<int> m_InOffsetData;
+	vector<int> m_InSourceData;
+	vector<int> m_InWeightData;
+
+	MappedFile *m_File;		// Read-only snapshot the arrays point into, nullptr when owned
+
+	// Rows changed since the arrays were built. A patched row replaces its array row until
+	// compact() folds every patch back into owned arrays. m_OutPatch / m_InPatch hold the
+	// m_Rows index of a vertex's row or -1, and stay empty until the first change.
+	struct Row
+	{
+		vector<int> ends;		// Targets (out) or sources (in), ascending
+		vector<int> weights;
+	};
+	vector<int> m_OutPatch;
+	vector<int> m_InPatch;
+	vector<Row> m_Rows;
+	long long m_PatchedSlots;	// Entries held in m_Rows
+	int m_EdgeDelta;			// Edges added minus removed since the arrays were built
+
+	void bindOwned();		// Point the arrays at the owned vectors
+	void buildIncoming();
+
+	void outRow(int vertex, const int *&ends, const int *&weights, int &count);
+	void inRow(int vertex, const int *&ends, const int *&weights, int &count);
+	int patchRow(bool incoming, int vertex);	// Index of the vertex's patched row, copied on first use
+	void compact();
+	void mergeAdjacent(int vertex, bool inWins, EdgeVisitor &visitor);
+
+public:
+	CsrGraph(bool type, int size);
+	CsrGraph(Graph *source);
+	// Edge list in insertion order, a repeated (from, to) keeps the last weight like insertEdge
+	CsrGraph(bool type, int size, const vector<int> &from, const vector<int> &to, const vector<int> &weight);
+	// Arrays read in place from file: offsets, targets, weights, in offsets, sources, in weights.
+	// The graph takes ownership of file.
+	CsrGraph(bool type, int size, int edges, const int *arrays, MappedFile *file);
+	~CsrGraph();
+
+	int edgeCount();
+
+	void getAdjacentEdges(int vertex, map<int, int> *m);
+	void getAdjacentEdgesDirect(int vertex, map<int, int> *m);
+	void insertEdge(int from, int to, int weight);
+	bool removeEdge(int from, int to);
+	bool printGraph(LogSink *fout);
+	void forEachOutEdge(int vertex, EdgeVisitor &visitor);
+	void forEachInEdge(int vertex, EdgeVisitor &visitor);
+	void forEachAdjacentEdge(int vertex, EdgeVisitor &visitor);
+	void forEachReverseAdjacentEdge(int vertex, EdgeVisitor &visitor);
+	int outDegree(int vertex);
+	int inDegree(int vertex);
+};
+
+#endif
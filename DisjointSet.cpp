@@ -0,0 +1,68 @@
+#include "DisjointSet.h"
+#include "Stats.h"
+
+DisjointSet::DisjointSet(int size)
+{
+    reset(size);
+}
+
+void DisjointSet::reset(int size)
+{
+    // Every vertex starts as its own root
+    m_Parent.resize(size);
+    m_Size.assign(size, 1);
+    for (int i = 0; i < size; i++)
+    {
+        m_Parent[i] = i;
+    }
+}
+
+int DisjointSet::find(int x)
+{
+    STAT_ADD(STAT_UNION_FIND, 1);
+
+    // Path halving: point every other node to its grandparent
+    while (m_Parent[x] != x)
+    {
+        m_Parent[x] = m_Parent[m_Parent[x]];
+        x = m_Parent[x];
+    }
+    return x;
+}
+
+int DisjointSet::findRoot(int x) const
+{
+    while (m_Parent[x] != x)
+    {
+        x = m_Parent[x];
+    }
+    return x;
+}
+
+bool DisjointSet::unite(int a, int b)
+{
+    STAT_ADD(STAT_UNION_FIND, 1);
+
+    a = find(a);
+    b = find(b);
+    if (a == b)
+    {
+        return false;
+    }
+
+    // Hang the smaller tree under the larger one
+    if (m_Size[a] < m_Size[b])
+    {
+        int t = a;
+        a = b;
+        b = t;
+    }
+    m_Parent[b] = a;
+    m_Size[a] += m_Size[b];
+    return true;
+}
+
+int DisjointSet::componentSize(int x)
+{
+    return m_Size[find(x)];
+}
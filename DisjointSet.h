@@ -0,0 +1,25 @@
+#ifndef _DISJOINTSET_H_
+#define _DISJOINTSET_H_
+
+#include <vector>
+
+using namespace std;
+
+// Union-find with union by size and path halving, no recursion
+class DisjointSet
+{
+private:
+	vector<int> m_Parent;
+	vector<int> m_Size;		// Valid for roots only
+
+public:
+	DisjointSet(int size = 0);
+
+	void reset(int size);
+	int find(int x);					// Root of x, halves the path on the way
+	int findRoot(int x) const;			// Root of x without modifying, safe from many threads
+	bool unite(int a, int b);			// false when a and b were already joined
+	int componentSize(int x);
+};
+
+#endif
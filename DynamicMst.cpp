@@ -0,0 +1,270 @@
+#include "DynamicMst.h"
+
+DynamicMst::DynamicMst()
+{
+    m_Valid = false;
+    m_Size = 0;
+    m_Edges = 0;
+    m_PairU = m_PairV = -1;
+    m_HadPair = false;
+    m_OldWeight = 0;
+    m_Stamp = 0;
+}
+
+void DynamicMst::reset()
+{
+    m_Valid = false;
+    m_Adj.clear();
+    m_Mark.clear();
+    m_Parent.clear();
+    m_UpWeight.clear();
+}
+
+bool DynamicMst::valid() const
+{
+    return m_Valid;
+}
+
+void DynamicMst::assign(int size, const vector<MstEdge> &forest)
+{
+    m_Valid = true;
+    m_Size = size;
+    m_Edges = 0;
+    m_Adj.assign(size, vector<pair<int, int>>());
+    for (auto &e : forest)
+    {
+        link(e);
+    }
+
+    m_Mark.assign(size, 0);
+    m_Stamp = 0;
+    m_Parent.assign(size, -1);
+    m_UpWeight.assign(size, 0);
+}
+
+bool DynamicMst::tree(vector<MstEdge> &edges) const
+{
+    edges.clear();
+    for (int u = 0; u < m_Size; u++)
+    {
+        for (auto &p : m_Adj[u])
+        {
+            if (u < p.first)
+            {
+                edges.push_back({p.second, u, p.first});
+            }
+        }
+    }
+
+    // Same rule as the engines: at least one edge and size - 1 of them
+    return m_Size > 1 && m_Edges == m_Size - 1;
+}
+
+// Weight Kruskal collects for the pair u < v
+bool DynamicMst::pairWeight(Graph *graph, int u, int v, int &weight)
+{
+    bool found = false;
+    forEachEdge(graph, u, 'X', [&](int y, int w)
+    {
+        if (y == v)
+        {
+            weight = w;
+            found = true;
+        }
+        return y < v;
+    });
+    return found;
+}
+
+void DynamicMst::link(const MstEdge &e)
+{
+    m_Adj[e.u].push_back({e.v, e.w});
+    m_Adj[e.v].push_back({e.u, e.w});
+    m_Edges++;
+}
+
+void DynamicMst::cut(int u, int v)
+{
+    for (int side = 0; side < 2; side++)
+    {
+        vector<pair<int, int>> &row = m_Adj[side ? v : u];
+        int other = side ? u : v;
+        for (size_t i = 0; i < row.size(); i++)
+        {
+            if (row[i].first == other)
+            {
+                row[i] = row.back();
+                row.pop_back();
+                break;
+            }
+        }
+    }
+    m_Edges--;
+}
+
+bool DynamicMst::inTree(int u, int v)
+{
+    // Scan the shorter row
+    const vector<pair<int, int>> &row = m_Adj[u].size() <= m_Adj[v].size() ? m_Adj[u] : m_Adj[v];
+    int other = &row == &m_Adj[u] ? v : u;
+    for (auto &p : row)
+    {
+        if (p.first == other)
+            return true;
+    }
+    return false;
+}
+
+// Heaviest key on the tree path from -> to, false when they are in different trees.
+// Walks the tree from `from` until `to` shows up, O(V).
+bool DynamicMst::pathMax(int from, int to, MstEdge &heaviest)
+{
+    int stamp = ++m_Stamp;
+    vector<int> &queue = m_Queue[0];
+    queue.clear();
+    queue.push_back(from);
+    m_Mark[from] = stamp;
+    m_Parent[from] = -1;
+
+    for (size_t head = 0; head < queue.size() && m_Mark[to] != stamp; head++)
+    {
+        int x = queue[head];
+        for (auto &p : m_Adj[x])
+        {
+            if (m_Mark[p.first] != stamp)
+            {
+                m_Mark[p.first] = stamp;
+                m_Parent[p.first] = x;
+                m_UpWeight[p.first] = p.second;
+                queue.push_back(p.first);
+            }
+        }
+    }
+    if (m_Mark[to] != stamp)
+    {
+        return false;
+    }
+
+    bool first = true;
+    for (int x = to; x != from; x = m_Parent[x])
+    {
+        int y = m_Parent[x];
+        MstEdge e = {m_UpWeight[x], min(x, y), max(x, y)};
+        if (first || heaviest < e)
+        {
+            heaviest = e;
+        }
+        first = false;
+    }
+    return true;
+}
+
+// Tree edge u - v was just cut: join the two sides again with the lightest pair between them
+void DynamicMst::reconnect(Graph *graph, int u, int v)
+{
+    // Grow both sides one vertex at a time, the side that runs out first is the smaller one
+    int stamp[2] = {m_Stamp + 1, m_Stamp + 2};
+    m_Stamp += 2;
+    size_t head[2] = {0, 0};
+    m_Queue[0].assign(1, u);
+    m_Queue[1].assign(1, v);
+    m_Mark[u] = stamp[0];
+    m_Mark[v] = stamp[1];
+
+    int small = -1;
+    while (small < 0)
+    {
+        for (int s = 0; s < 2 && small < 0; s++)
+        {
+            vector<int> &queue = m_Queue[s];
+            if (head[s] == queue.size())
+            {
+                small = s;
+                break;
+            }
+            int x = queue[head[s]++];
+            for (auto &p : m_Adj[x])
+            {
+                if (m_Mark[p.first] != stamp[s])
+                {
+                    m_Mark[p.first] = stamp[s];
+                    queue.push_back(p.first);
+                }
+            }
+        }
+    }
+
+    // A pair leaving the smaller side can only reach the other side, as a minimum
+    // forest never leaves two of its trees joined by a graph edge
+    bool found = false;
+    MstEdge best = {0, 0, 0};
+    for (int x : m_Queue[small])
+    {
+        forEachMstEdge(graph, x, [&](int y, int w)
+        {
+            if (m_Mark[y] == stamp[small])
+                return;
+            MstEdge e = {w, min(x, y), max(x, y)};
+            if (!found || e < best)
+            {
+                best = e;
+                found = true;
+            }
+        });
+    }
+
+    if (found)
+    {
+        link(best);
+    }
+}
+
+void DynamicMst::beforeChange(Graph *graph, int from, int to)
+{
+    if (!m_Valid)
+    {
+        return;
+    }
+
+    m_PairU = min(from, to);
+    m_PairV = max(from, to);
+    m_HadPair = m_PairU != m_PairV && pairWeight(graph, m_PairU, m_PairV, m_OldWeight);
+}
+
+void DynamicMst::afterChange(Graph *graph)
+{
+    // Self loops never enter the forest
+    if (!m_Valid || m_PairU == m_PairV)
+    {
+        return;
+    }
+
+    int weight = 0;
+    bool hasPair = pairWeight(graph, m_PairU, m_PairV, weight);
+    if (hasPair == m_HadPair && (!hasPair || weight == m_OldWeight))
+    {
+        return;
+    }
+
+    // A changed key leaves as the old pair and comes back as a new one
+    if (m_HadPair && inTree(m_PairU, m_PairV))
+    {
+        cut(m_PairU, m_PairV);
+        reconnect(graph, m_PairU, m_PairV);
+    }
+
+    if (hasPair)
+    {
+        MstEdge e = {weight, m_PairU, m_PairV};
+        MstEdge heaviest;
+        if (!pathMax(m_PairU, m_PairV, heaviest))
+        {
+            link(e);
+        }
+        else if (e < heaviest)
+        {
+            cut(heaviest.u, heaviest.v);
+            link(e);
+        }
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef _DYNAMICMST_H_
+#define _DYNAMICMST_H_
+
+#include "SpanningTree.h"
+
+// Minimum spanning forest of the undirected view kept up to date across edge changes.
+// Keys are (w, u, v) like Kruskal's sort, so the forest is unique and always the one
+// a full recompute would pick. A new or cheaper pair replaces the heaviest edge on its
+// tree path; a lost tree edge is replaced by the lightest pair leaving the smaller side.
+class DynamicMst
+{
+private:
+	bool m_Valid;
+	int m_Size;
+	int m_Edges;
+	vector<vector<pair<int, int>>> m_Adj;	// Tree neighbors (vertex, weight)
+
+	// Undirected pair touched by the pending change, u < v
+	int m_PairU;
+	int m_PairV;
+	bool m_HadPair;
+	int m_OldWeight;
+
+	// Search workspace, m_Mark holds the stamp of the search that reached a vertex
+	vector<int> m_Mark;
+	int m_Stamp;
+	vector<int> m_Parent;
+	vector<int> m_UpWeight;		// Weight of the edge to m_Parent
+	vector<int> m_Queue[2];
+
+	bool pairWeight(Graph *graph, int u, int v, int &weight);
+	void link(const MstEdge &e);
+	void cut(int u, int v);
+	bool inTree(int u, int v);
+	bool pathMax(int from, int to, MstEdge &heaviest);
+	void reconnect(Graph *graph, int u, int v);
+
+public:
+	DynamicMst();
+
+	void reset();
+	bool valid() const;
+	void assign(int size, const vector<MstEdge> &forest);
+	bool tree(vector<MstEdge> &edges) const;	// false unless the forest spans every vertex
+
+	// Call around a change of the directed edge from -> to
+	void beforeChange(Graph *graph, int from, int to);
+	void afterChange(Graph *graph);
+};
+
+#endif
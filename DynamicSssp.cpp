@@ -0,0 +1,282 @@
+#include "DynamicSssp.h"
+#include "Stats.h"
+
+// Per-vertex flags of one update
+static const unsigned char SSSP_CHECKED = 1;     // Support already examined
+static const unsigned char SSSP_AFFECTED = 2;    // Lost every shortest path, distance recomputed
+static const unsigned char SSSP_CHANGED = 4;     // Distance went down
+static const unsigned char SSSP_DIRTY = 8;       // Parent must be picked again
+
+DynamicSssp::DynamicSssp()
+{
+    m_Valid = false;
+    m_Option = 'O';
+    m_Source = -1;
+    m_ArcCount = 0;
+}
+
+void DynamicSssp::reset()
+{
+    m_Valid = false;
+    m_Dist.clear();
+    m_Prev.clear();
+}
+
+bool DynamicSssp::matches(char option, int source) const
+{
+    return m_Valid && m_Option == option && m_Source == source;
+}
+
+void DynamicSssp::assign(char option, int source, vector<int> &dist, vector<int> &prev)
+{
+    m_Valid = true;
+    m_Option = option;
+    m_Source = source;
+    m_Dist.swap(dist);
+    m_Prev.swap(prev);
+    m_Flag.assign(m_Dist.size(), 0);
+    m_Touched.clear();
+}
+
+const vector<int> &DynamicSssp::dist() const
+{
+    return m_Dist;
+}
+
+const vector<int> &DynamicSssp::prev() const
+{
+    return m_Prev;
+}
+
+void DynamicSssp::mark(int v, unsigned char flag)
+{
+    if (m_Flag[v] == 0)
+    {
+        m_Touched.push_back(v);
+    }
+    m_Flag[v] |= flag;
+}
+
+// Weight of the arc from -> to in the tree's view
+bool DynamicSssp::arcWeight(Graph *graph, int from, int to, int &weight)
+{
+    bool found = false;
+    forEachEdge(graph, from, m_Option, [&](int v, int w)
+    {
+        if (v == to)
+        {
+            weight = w;
+            found = true;
+        }
+        return v < to;
+    });
+    return found;
+}
+
+// Parent a fresh Dijkstra would give v: with positive weights vertices settle in
+// (dist, id) order and the first settled tight predecessor relaxes v last
+int DynamicSssp::bestParent(Graph *graph, int v)
+{
+    int best = -1;
+    forEachReverseEdge(graph, v, m_Option, [&](int y, int w)
+    {
+        // Ascending y, so strict < keeps the smaller id on ties
+        if (m_Dist[y] != INF && m_Dist[y] + w == m_Dist[v] && (best < 0 || m_Dist[y] < m_Dist[best]))
+        {
+            best = y;
+        }
+        return true;
+    });
+    return best;
+}
+
+void DynamicSssp::beforeChange(Graph *graph, int from, int to)
+{
+    if (!m_Valid)
+    {
+        return;
+    }
+
+    m_ArcCount = 0;
+    m_ArcTail[m_ArcCount] = from;
+    m_ArcHead[m_ArcCount++] = to;
+    if (m_Option != 'O' && from != to)
+    {
+        m_ArcTail[m_ArcCount] = to;
+        m_ArcHead[m_ArcCount++] = from;
+    }
+
+    for (int i = 0; i < m_ArcCount; i++)
+    {
+        m_HadArc[i] = arcWeight(graph, m_ArcTail[i], m_ArcHead[i], m_OldWeight[i]);
+    }
+}
+
+void DynamicSssp::afterChange(Graph *graph, bool positive)
+{
+    if (!m_Valid)
+    {
+        return;
+    }
+    if (!positive)
+    {
+        // Zero weights make the settle order depend on history, recompute next time
+        reset();
+        return;
+    }
+
+    greater<pair<int, int>> later;
+    vector<pair<int, int>> heap;
+    vector<int> affected;
+
+    // Arcs that got heavier or vanished while on a shortest path start the search
+    bool hasArc[2];
+    int newWeight[2];
+    for (int i = 0; i < m_ArcCount; i++)
+    {
+        int tail = m_ArcTail[i], head = m_ArcHead[i];
+        hasArc[i] = arcWeight(graph, tail, head, newWeight[i]);
+        mark(head, SSSP_DIRTY);
+
+        bool worse = m_HadArc[i] && (!hasArc[i] || newWeight[i] > m_OldWeight[i]);
+        if (worse && head != m_Source && m_Dist[tail] != INF && m_Dist[tail] + m_OldWeight[i] == m_Dist[head])
+        {
+            heap.push_back(make_pair(m_Dist[head], head));
+            push_heap(heap.begin(), heap.end(), later);
+        }
+    }
+
+    // Affected vertices: no tight arc left from an unaffected vertex. Tight parents are
+    // strictly closer, so checking in distance order sees every parent decided first.
+    while (!heap.empty())
+    {
+        pop_heap(heap.begin(), heap.end(), later);
+        int x = heap.back().second;
+        heap.pop_back();
+
+        if (m_Flag[x] & SSSP_CHECKED)
+        {
+            continue;
+        }
+        mark(x, SSSP_CHECKED);
+
+        bool supported = false;
+        forEachReverseEdge(graph, x, m_Option, [&](int y, int w)
+        {
+            supported = !(m_Flag[y] & SSSP_AFFECTED) && m_Dist[y] != INF && m_Dist[y] + w == m_Dist[x];
+            return !supported;
+        });
+        if (supported)
+        {
+            continue;
+        }
+
+        mark(x, SSSP_AFFECTED);
+        affected.push_back(x);
+        forEachEdge(graph, x, m_Option, [&](int z, int w)
+        {
+            if (z != m_Source && !(m_Flag[z] & SSSP_CHECKED) && m_Dist[x] + w == m_Dist[z])
+            {
+                heap.push_back(make_pair(m_Dist[z], z));
+                push_heap(heap.begin(), heap.end(), later);
+            }
+            return true;
+        });
+    }
+
+    // Affected vertices restart from their best unaffected parent
+    for (int x : affected)
+    {
+        m_Dist[x] = INF;
+    }
+    for (int x : affected)
+    {
+        int best = INF;
+        forEachReverseEdge(graph, x, m_Option, [&](int y, int w)
+        {
+            if (!(m_Flag[y] & SSSP_AFFECTED) && m_Dist[y] != INF && m_Dist[y] + w < best)
+            {
+                best = m_Dist[y] + w;
+            }
+            return true;
+        });
+        if (best != INF)
+        {
+            m_Dist[x] = best;
+            heap.push_back(make_pair(best, x));
+            push_heap(heap.begin(), heap.end(), later);
+        }
+    }
+
+    // Arcs that got lighter or appeared may shorten paths
+    for (int i = 0; i < m_ArcCount; i++)
+    {
+        int tail = m_ArcTail[i], head = m_ArcHead[i];
+        bool better = hasArc[i] && (!m_HadArc[i] || newWeight[i] < m_OldWeight[i]);
+        if (better && m_Dist[tail] != INF && m_Dist[head] > m_Dist[tail] + newWeight[i])
+        {
+            m_Dist[head] = m_Dist[tail] + newWeight[i];
+            mark(head, SSSP_CHANGED);
+            heap.push_back(make_pair(m_Dist[head], head));
+            push_heap(heap.begin(), heap.end(), later);
+        }
+    }
+
+    // Dijkstra limited to the region whose distances move
+    while (!heap.empty())
+    {
+        pop_heap(heap.begin(), heap.end(), later);
+        int cost = heap.back().first;
+        int x = heap.back().second;
+        heap.pop_back();
+        STAT_ADD(STAT_POPS, 1);
+
+        // Skip outdated entries
+        if (cost > m_Dist[x])
+        {
+            continue;
+        }
+        STAT_ADD(STAT_SETTLED, 1);
+
+        forEachEdge(graph, x, m_Option, [&](int z, int w)
+        {
+            STAT_ADD(STAT_RELAXED, 1);
+            if (m_Dist[z] > m_Dist[x] + w)
+            {
+                m_Dist[z] = m_Dist[x] + w;
+                mark(z, SSSP_CHANGED);
+                STAT_ADD(STAT_PUSHES, 1);
+                heap.push_back(make_pair(m_Dist[z], z));
+                push_heap(heap.begin(), heap.end(), later);
+            }
+            return true;
+        });
+    }
+
+    // A moved vertex and everything it points at may need another parent
+    int moved = (int)m_Touched.size();
+    for (int i = 0; i < moved; i++)
+    {
+        int x = m_Touched[i];
+        if (!(m_Flag[x] & (SSSP_AFFECTED | SSSP_CHANGED)))
+        {
+            continue;
+        }
+        mark(x, SSSP_DIRTY);
+        forEachEdge(graph, x, m_Option, [&](int z, int)
+        {
+            mark(z, SSSP_DIRTY);
+            return true;
+        });
+    }
+
+    for (int v : m_Touched)
+    {
+        if ((m_Flag[v] & SSSP_DIRTY) && v != m_Source)
+        {
+            m_Prev[v] = m_Dist[v] == INF ? -1 : bestParent(graph, v);
+        }
+        m_Flag[v] = 0;
+    }
+    m_Touched.clear();
+}
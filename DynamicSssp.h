@@ -0,0 +1,49 @@
+#ifndef _DYNAMICSSSP_H_
+#define _DYNAMICSSSP_H_
+
+#include "Graph.h"
+
+// Dijkstra tree of one designated (option, source) kept up to date across edge changes,
+// Ramalingam-Reps style: only vertices whose distance or parent can change are visited.
+// prev matches a fresh Dijkstra, the tight parent with the smallest (dist, id). That only
+// holds when every weight is positive, so any other graph drops the tree instead.
+class DynamicSssp
+{
+private:
+	bool m_Valid;
+	char m_Option;
+	int m_Source;
+	vector<int> m_Dist;
+	vector<int> m_Prev;
+
+	// Arcs of the view that one edge change can touch: from -> to and, undirected, to -> from
+	int m_ArcCount;
+	int m_ArcTail[2];
+	int m_ArcHead[2];
+	bool m_HadArc[2];
+	int m_OldWeight[2];
+
+	// Per-vertex flags, cleared through m_Touched after each update
+	vector<unsigned char> m_Flag;
+	vector<int> m_Touched;
+
+	void mark(int v, unsigned char flag);
+	bool arcWeight(Graph *graph, int from, int to, int &weight);
+	int bestParent(Graph *graph, int v);
+
+public:
+	DynamicSssp();
+
+	void reset();
+	bool matches(char option, int source) const;
+	void assign(char option, int source, vector<int> &dist, vector<int> &prev);	// Takes the vectors' contents
+	const vector<int> &dist() const;
+	const vector<int> &prev() const;
+
+	// Call around a change of the directed edge from -> to.
+	// positive tells whether every edge weight is still > 0 afterwards.
+	void beforeChange(Graph *graph, int from, int to);
+	void afterChange(Graph *graph, bool positive);
+};
+
+#endif
@@ -0,0 +1,112 @@
+#include "FloydWarshall.h"
+#include "ThreadPool.h"
+#include "Stats.h"
+
+// Tile edge length, a tile is FLOYD_TILE x FLOYD_TILE distances
+static const int FLOYD_TILE = 64;
+
+// c[i][j] = min(c[i][j], a[i][k] + b[k][j]) over one tile, k outermost so c may alias a or b.
+// Sums involving INF saturate to INF, so unreachable cells stay exactly INF.
+#if defined(__GNUC__) && !defined(__clang__)
+__attribute__((optimize("tree-vectorize")))
+#endif
+static void minPlusTile(int *c, const int *a, const int *b, int stride)
+{
+    for (int k = 0; k < FLOYD_TILE; k++)
+    {
+        const int *bk = b + (size_t)k * stride;
+        for (int i = 0; i < FLOYD_TILE; i++)
+        {
+            int aik = a[(size_t)i * stride + k];
+            if (aik >= INF)
+                continue;
+            STAT_ADD(STAT_FLOYD_INNER, FLOYD_TILE);
+
+            int *ci = c + (size_t)i * stride;
+            // Branch-free inner loop
+            for (int j = 0; j < FLOYD_TILE; j++)
+            {
+                int via = bk[j] < INF ? aik + bk[j] : INF;
+                ci[j] = via < ci[j] ? via : ci[j];
+            }
+        }
+    }
+}
+
+bool blockedFloyd(Graph *graph, char option, vector<int> &dist)
+{
+    int n = graph->getSize();
+    int tiles = (n + FLOYD_TILE - 1) / FLOYD_TILE;
+    int stride = tiles * FLOYD_TILE;
+
+    // Padded matrix, padding vertices have no edges
+    vector<int> work((size_t)stride * stride, INF);
+    for (int u = 0; u < n; u++)
+    {
+        int *row = &work[(size_t)u * stride];
+        forEachEdge(graph, u, option, [&](int v, int w)
+        {
+            row[v] = w;
+            return true;
+        });
+    }
+
+    // Consider self-loop
+    for (int i = 0; i < stride; i++)
+    {
+        work[(size_t)i * stride + i] = min(work[(size_t)i * stride + i], 0);
+    }
+
+    ThreadPool &pool = defaultPool();
+    int *base = &work[0];
+    auto tile = [&](int ti, int tj)
+    {
+        return base + (size_t)ti * FLOYD_TILE * stride + (size_t)tj * FLOYD_TILE;
+    };
+
+    for (int kt = 0; kt < tiles; kt++)
+    {
+        int *pivot = tile(kt, kt);
+
+        // Phase 1: pivot tile against itself
+        minPlusTile(pivot, pivot, pivot, stride);
+
+        // Phase 2: tiles in the pivot row and pivot column
+        pool.parallelFor(2 * tiles, [&](int idx, int)
+        {
+            int t = idx / 2;
+            if (t == kt)
+                return;
+            if (idx % 2 == 0)
+                minPlusTile(tile(kt, t), pivot, tile(kt, t), stride);
+            else
+                minPlusTile(tile(t, kt), tile(t, kt), pivot, stride);
+        });
+
+        // Phase 3: every remaining tile, each one independent
+        pool.parallelFor(tiles * tiles, [&](int idx, int)
+        {
+            int ti = idx / tiles, tj = idx % tiles;
+            if (ti == kt || tj == kt)
+                return;
+            minPlusTile(tile(ti, tj), tile(ti, kt), tile(kt, tj), stride);
+        });
+    }
+
+    // Check negative cycle
+    for (int i = 0; i < n; i++)
+    {
+        if (work[(size_t)i * stride + i] < 0)
+        {
+            return false;
+        }
+    }
+
+    // Drop the padding
+    dist.resize((size_t)n * n);
+    for (int i = 0; i < n; i++)
+    {
+        copy(work.begin() + (size_t)i * stride, work.begin() + (size_t)i * stride + n, dist.begin() + (size_t)i * n);
+    }
+    return true;
+}
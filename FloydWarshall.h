@@ -0,0 +1,13 @@
+#ifndef _FLOYDWARSHALL_H_
+#define _FLOYDWARSHALL_H_
+
+#include "Graph.h"
+
+// Tiled all-pairs shortest paths.
+// Fills dist with the n x n row-major distance matrix (INF when unreachable),
+// using edges picked by option ('O' = directed, otherwise undirected).
+// Independent tiles of each phase run on defaultPool() (DS_THREADS threads).
+// Returns false when a negative cycle exists.
+bool blockedFloyd(Graph *graph, char option, vector<int> &dist);
+
+#endif
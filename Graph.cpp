@@ -13,4 +13,36 @@ Graph::~Graph()
 
 
 bool Graph::getType(){return m_Type;}	
-int Graph::getSize(){return m_Size;}
\ No newline at end of file
+int Graph::getSize(){return m_Size;}
+
+void Graph::forEachEdge(int vertex, char option, EdgeVisitor &visitor)
+{
+	if (option == 'O')
+		forEachOutEdge(vertex, visitor);
+	else
+		forEachAdjacentEdge(vertex, visitor);
+}
+
+void Graph::forEachReverseEdge(int vertex, char option, EdgeVisitor &visitor)
+{
+	if (option == 'O')
+		forEachInEdge(vertex, visitor);
+	else
+		forEachReverseAdjacentEdge(vertex, visitor);
+}
+
+bool Graph::findEdge(int from, int to, int &weight)
+{
+	bool found = false;
+	// Neighbors come in ascending order, stop once past to
+	::forEachEdge(this, from, 'O', [&](int v, int w)
+	{
+		if (v == to)
+		{
+			weight = w;
+			found = true;
+		}
+		return v < to;
+	});
+	return found;
+}
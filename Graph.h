@@ -13,9 +13,22 @@
 #include <deque>
 #include <queue>
 #include <stack>
+#include "LogSink.h"
 
 using namespace std;
 
+// Distance used for unreachable vertices
+const int INF = 1e9;
+
+// Receives (to, weight) pairs from the neighbor iteration API.
+// visit returns false to stop the iteration early.
+class EdgeVisitor
+{
+public:
+	virtual ~EdgeVisitor() {}
+	virtual bool visit(int to, int weight) = 0;
+};
+
 class Graph{	
 protected:
 	bool m_Type;
@@ -31,7 +44,45 @@ public:
 	virtual void getAdjacentEdges(int vertex, map<int, int>* m) = 0;		
 	virtual void getAdjacentEdgesDirect(int vertex, map<int, int>* m) = 0;	
 	virtual void insertEdge(int from, int to, int weight) = 0;				
-	virtual	bool printGraph(ofstream *fout) = 0;
+	virtual bool removeEdge(int from, int to) = 0;							// False when there is no such edge
+	virtual	bool printGraph(LogSink *fout) = 0;
+
+	// Allocation-free neighbor iteration, all in ascending neighbor order
+	virtual void forEachOutEdge(int vertex, EdgeVisitor &visitor) = 0;			// (to, weight) of vertex -> to
+	virtual void forEachInEdge(int vertex, EdgeVisitor &visitor) = 0;			// (from, weight) of from -> vertex
+	virtual void forEachAdjacentEdge(int vertex, EdgeVisitor &visitor) = 0;	// Undirected, same result as getAdjacentEdges
+	virtual void forEachReverseAdjacentEdge(int vertex, EdgeVisitor &visitor) = 0;	// (from, weight) of undirected arcs from -> vertex
+	virtual int outDegree(int vertex) = 0;
+	virtual int inDegree(int vertex) = 0;
+	void forEachEdge(int vertex, char option, EdgeVisitor &visitor);			// 'O' = directed, otherwise undirected
+	void forEachReverseEdge(int vertex, char option, EdgeVisitor &visitor);	// Arcs into vertex of the same view
+	bool findEdge(int from, int to, int &weight);								// Weight of the directed edge from -> to
 };
 
+// Adapts any callable bool(int to, int weight) to EdgeVisitor
+template <class F>
+class FunctionVisitor : public EdgeVisitor
+{
+private:
+	F &m_Func;
+
+public:
+	FunctionVisitor(F &func) : m_Func(func) {}
+	bool visit(int to, int weight) { return m_Func(to, weight); }
+};
+
+template <class F>
+void forEachEdge(Graph *graph, int vertex, char option, F func)
+{
+	FunctionVisitor<F> visitor(func);
+	graph->forEachEdge(vertex, option, visitor);
+}
+
+template <class F>
+void forEachReverseEdge(Graph *graph, int vertex, char option, F func)
+{
+	FunctionVisitor<F> visitor(func);
+	graph->forEachReverseEdge(vertex, option, visitor);
+}
+
 #endif
\ No newline at end of file
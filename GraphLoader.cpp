@@ -0,0 +1,386 @@
+#include "GraphLoader.h"
+#include "ListGraph.h"
+#include "MatrixGraph.h"
+#include "CsrGraph.h"
+#include "ThreadPool.h"
+#include <cstring>
+#include <climits>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// M bodies shorter than this are parsed on the calling thread
+static const size_t PARALLEL_PARSE_MIN = 1 << 20;
+
+MappedFile::MappedFile()
+{
+    m_Data = nullptr;
+    m_Length = 0;
+    m_Mapped = false;
+}
+
+MappedFile::~MappedFile()
+{
+    release();
+}
+
+void MappedFile::release()
+{
+    if (m_Mapped)
+    {
+        munmap((void *)m_Data, m_Length);
+    }
+    m_Data = nullptr;
+    m_Length = 0;
+    m_Mapped = false;
+    m_Buffer.clear();
+}
+
+bool MappedFile::open(const char *path)
+{
+    release();
+
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0)
+    {
+        void *addr = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr != MAP_FAILED)
+        {
+            madvise(addr, (size_t)st.st_size, MADV_SEQUENTIAL);
+            m_Data = (const char *)addr;
+            m_Length = (size_t)st.st_size;
+            m_Mapped = true;
+            close(fd);
+            return true;
+        }
+    }
+
+    // Read whatever the descriptor gives, a read error leaves the data empty
+    char chunk[1 << 16];
+    ssize_t got;
+    while ((got = read(fd, chunk, sizeof(chunk))) > 0)
+    {
+        m_Buffer.insert(m_Buffer.end(), chunk, chunk + got);
+    }
+    close(fd);
+
+    m_Data = m_Buffer.data();
+    m_Length = m_Buffer.size();
+    return true;
+}
+
+const char *MappedFile::data() const
+{
+    return m_Data;
+}
+
+size_t MappedFile::size() const
+{
+    return m_Length;
+}
+
+// Whitespace as the C locale sees it
+static inline bool isSpace(char c)
+{
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+// One "stream >> int": skip whitespace, optional sign, digits. Fails on no digits or
+// int overflow. Also matches stoi, which reads the same prefix and ignores the rest.
+static inline bool readInt(const char *&p, const char *end, int &value)
+{
+    while (p < end && isSpace(*p))
+        p++;
+
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+'))
+    {
+        negative = *p == '-';
+        p++;
+    }
+    if (p == end || (unsigned)(*p - '0') > 9)
+        return false;
+
+    // Accumulate negatively so INT_MIN fits
+    long long acc = 0;
+    bool overflow = false;
+    do
+    {
+        acc = acc * 10 - (*p - '0');
+        overflow |= acc < INT_MIN;
+        if (overflow)
+            acc = INT_MIN;
+        p++;
+    } while (p < end && (unsigned)(*p - '0') <= 9);
+
+    if (!negative)
+    {
+        if (acc == INT_MIN)
+            overflow = true;
+        acc = -acc;
+    }
+    if (overflow)
+        return false;
+
+    value = (int)acc;
+    return true;
+}
+
+// One getline: the line runs to the next '\n' (consumed) or the end. Fails only at the end.
+static inline bool readLine(const char *&p, const char *end, const char *&first, const char *&last)
+{
+    if (p >= end)
+        return false;
+
+    first = p;
+    const char *nl = (const char *)memchr(p, '\n', end - p);
+    last = nl ? nl : end;
+    p = nl ? nl + 1 : end;
+    return true;
+}
+
+// L body: a start line, then "to weight" lines until the next single-number line
+static Graph *parseList(const char *p, const char *end, int size, bool csr)
+{
+    ListGraph *list = nullptr;
+    vector<int> from, to, weight;
+
+    if (csr)
+    {
+        // First pass: line count bounds the edge count
+        size_t lines = 1;
+        for (const char *q = p; (q = (const char *)memchr(q, '\n', end - q)) != nullptr; q++)
+            lines++;
+        from.reserve(lines);
+        to.reserve(lines);
+        weight.reserve(lines);
+    }
+    else
+    {
+        list = new ListGraph(true, size);
+    }
+
+    const char *first, *last;
+    bool ok = true;
+
+    // Rest of the header line
+    readLine(p, end, first, last);
+
+    int next_start = -1;
+
+    for (int cur = 0; cur < size && ok; cur++)
+    {
+        // Read start
+        if (next_start == -1)
+        {
+            if (!readLine(p, end, first, last) || !readInt(first, last, next_start))
+            {
+                ok = false;
+                break;
+            }
+        }
+
+        int start = next_start;
+        next_start = -1;
+
+        // Read edge
+        while (readLine(p, end, first, last))
+        {
+            if (first == last)
+                continue;
+
+            int nums[2];
+            int count = 0, x;
+            while (count < 3 && readInt(first, last, x))
+            {
+                if (count < 2)
+                    nums[count] = x;
+                count++;
+            }
+
+            if (count == 1)
+            {
+                next_start = nums[0];
+                break;
+            }
+            else if (count == 2 && start >= 0 && start < size && nums[0] >= 0 && nums[0] < size)
+            {
+                if (csr)
+                {
+                    from.push_back(start);
+                    to.push_back(nums[0]);
+                    weight.push_back(nums[1]);
+                }
+                else
+                {
+                    list->insertEdge(start, nums[0], nums[1]);
+                }
+            }
+            else
+            {
+                ok = false;
+                break;
+            }
+        }
+    }
+
+    if (!ok)
+    {
+        delete list;
+        return nullptr;
+    }
+    if (csr)
+    {
+        return new CsrGraph(true, size, from, to, weight);
+    }
+    return list;
+}
+
+// M body: size * size integers separated by any whitespace
+static MatrixGraph *parseMatrix(const char *p, const char *end, int size)
+{
+    MatrixGraph *matrix = new MatrixGraph(false, size);
+    long long cells = (long long)size * size;
+    ThreadPool &pool = defaultPool();
+
+    if (pool.size() < 2 || (size_t)(end - p) < PARALLEL_PARSE_MIN)
+    {
+        for (long long c = 0; c < cells; c++)
+        {
+            int weight;
+            if (!readInt(p, end, weight))
+            {
+                delete matrix;
+                return nullptr;
+            }
+            if (weight != 0)
+            {
+                matrix->insertEdge((int)(c / size), (int)(c % size), weight);
+            }
+        }
+        return matrix;
+    }
+
+    // Chunk boundaries are moved forward onto whitespace so no token is split
+    int chunks = pool.size() * 4;
+    vector<const char *> bound(chunks + 1);
+    bound[0] = p;
+    bound[chunks] = end;
+    for (int c = 1; c < chunks; c++)
+    {
+        const char *b = p + (size_t)(end - p) * c / chunks;
+        if (b < bound[c - 1])
+            b = bound[c - 1];
+        while (b < end && !isSpace(*b))
+            b++;
+        bound[c] = b;
+    }
+
+    // First pass: integers per chunk before its first bad token
+    vector<long long> count(chunks, 0);
+    vector<char> bad(chunks, 0);
+    pool.parallelFor(chunks, [&](int c, int)
+    {
+        const char *q = bound[c];
+        const char *stop = bound[c + 1];
+        int value;
+        while (true)
+        {
+            while (q < stop && isSpace(*q))
+                q++;
+            if (q == stop)
+                break;
+            if (!readInt(q, stop, value))
+            {
+                bad[c] = 1;
+                break;
+            }
+            count[c]++;
+        }
+    });
+
+    // The file is good when enough integers come before the first bad token
+    // Chunks past the last needed one get base = cells and write nothing
+    vector<long long> base(chunks, cells);
+    long long total = 0;
+    bool ok = false;
+    for (int c = 0; c < chunks; c++)
+    {
+        base[c] = total;
+        total += count[c];
+        if (total >= cells)
+        {
+            ok = true;
+            break;
+        }
+        if (bad[c])
+            break;
+    }
+    if (!ok)
+    {
+        delete matrix;
+        return nullptr;
+    }
+
+    // Second pass: each chunk knows its first cell index, cells are disjoint
+    pool.parallelFor(chunks, [&](int c, int)
+    {
+        const char *q = bound[c];
+        long long cell = base[c];
+        long long stop = min(cells, base[c] + count[c]);
+        int weight = 0;
+        for (; cell < stop; cell++)
+        {
+            // The first pass counted these tokens, stop anyway if one fails to parse
+            if (!readInt(q, bound[c + 1], weight))
+                break;
+            if (weight != 0)
+            {
+                matrix->setCell((int)(cell / size), (int)(cell % size), weight);
+            }
+        }
+    });
+    matrix->recountDegrees();
+
+    return matrix;
+}
+
+Graph *parseGraphText(const char *data, size_t size, bool csr)
+{
+    const char *p = data;
+    const char *end = data + size;
+
+    // Header: type character and vertex count
+    while (p < end && isSpace(*p))
+        p++;
+    if (p == end)
+        return nullptr;
+    char typeChar = *p++;
+
+    int vertices;
+    if (!readInt(p, end, vertices) || (typeChar != 'L' && typeChar != 'M') || vertices <= 0)
+        return nullptr;
+
+    if (typeChar == 'L')
+    {
+        return parseList(p, end, vertices, csr);
+    }
+
+    MatrixGraph *matrix = parseMatrix(p, end, vertices);
+    if (matrix == nullptr || !csr)
+    {
+        return matrix;
+    }
+
+    // Freeze into flat CSR arrays
+    Graph *frozen = new CsrGraph(matrix);
+    delete matrix;
+    return frozen;
+}
@@ -0,0 +1,33 @@
+#ifndef _GRAPHLOADER_H_
+#define _GRAPHLOADER_H_
+
+#include "Graph.h"
+#include <cstddef>
+
+// Read-only view of a whole file. Uses mmap, or reads the file into memory
+// when it cannot be mapped (pipes, special files).
+class MappedFile
+{
+private:
+	const char *m_Data;
+	size_t m_Length;
+	bool m_Mapped;			// m_Data comes from mmap rather than m_Buffer
+	vector<char> m_Buffer;
+
+	void release();
+
+public:
+	MappedFile();
+	~MappedFile();
+
+	bool open(const char *path);	// false when the file cannot be opened
+	const char *data() const;
+	size_t size() const;
+};
+
+// Parses an L or M text graph with the same rules as the original stream parser.
+// csr builds a CsrGraph (L files skip the ListGraph step). M rows are parsed
+// in parallel chunks on defaultPool(). Returns nullptr for a malformed file.
+Graph *parseGraphText(const char *data, size_t size, bool csr);
+
+#endif
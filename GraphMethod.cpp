@@ -1,6 +1,12 @@
 #include <iostream>
 #include <vector>
 #include "GraphMethod.h"
+#include "FloydWarshall.h"
+#include "ShortestPath.h"
+#include "BfsEngine.h"
+#include "SpanningTree.h"
+#include "ThreadPool.h"
+#include "Stats.h"
 #include <stack>
 #include <queue>
 #include <map>
@@ -13,10 +19,8 @@
 
 using namespace std;
 
-const int INF = 1e9;
-
 // Perform BFS traversal
-bool BFS(Graph *graph, char option, int vertex, ofstream *fout)
+bool BFS(Graph *graph, char option, int vertex, LogSink *fout)
 {
     int size = graph->getSize();
 
@@ -37,57 +41,73 @@ bool BFS(Graph *graph, char option, int vertex, ofstream *fout)
     }
     *fout << "Start: " << vertex << "\n";
 
-    vector<bool> visited(size, false);
-    queue<int> Q;
-
-    // Visit start vertex
-    visited[vertex] = true;
-    Q.push(vertex);
-
-    bool first = true;
+    // Direction-optimizing BFS, same order as a plain queue BFS
+    vector<int> order;
+    directionOptimizingBfs(graph, option, vertex, order);
 
-    while (!Q.empty())
+    for (int i = 0; i < order.size(); i++)
     {
-        int cur = Q.front();
-        Q.pop();
-
-        if (first)
+        if (i == 0)
         {
-            *fout << cur, first = false;
+            *fout << order[i];
         }
         else
         {
-            *fout << " -> " << cur;
+            *fout << " -> " << order[i];
         }
+    }
 
-        map<int, int> adj;
-        if (option == 'O')
-        {
-            graph->getAdjacentEdgesDirect(cur, &adj);
-        }
-        else
+    *fout << "\n====================\n\n";
+    return true;
+}
+
+// Label every vertex reachable from vertex with its hop level
+bool Reach(Graph *graph, char option, int vertex, LogSink *fout)
+{
+    int size = graph->getSize();
+
+    // Check valid range
+    if (vertex < 0 || vertex >= size)
+    {
+        return false;
+    }
+
+    // Parallel level-synchronous search, no visit order needed
+    vector<int> level;
+    bfsLevels(graph, option, vertex, level);
+
+    *fout << "========REACH========\n";
+    if (option == 'O')
+    {
+        *fout << "Directed Graph Reach" << "\n";
+    }
+    else
+    {
+        *fout << "Undirected Graph Reach" << "\n";
+    }
+    *fout << "Start: " << vertex << "\n";
+
+    // Reachable vertices in ascending order as vertex(level)
+    int count = 0;
+    for (int v = 0; v < size; v++)
+    {
+        if (level[v] < 0)
         {
-            graph->getAdjacentEdges(cur, &adj);
+            continue;
         }
-
-        // Visit neighbor vertexs
-        for (auto &p : adj)
+        if (count++)
         {
-            int next = p.first;
-            if (!visited[next])
-            {
-                visited[next] = true;
-                Q.push(next);
-            }
+            *fout << " ";
         }
+        *fout << v << "(" << level[v] << ")";
     }
-
-    *fout << "\n====================\n\n";
+    *fout << "\nCount: " << count << "\n";
+    *fout << "====================\n\n";
     return true;
 }
 
 // Perform DFS traversal
-bool DFS(Graph *graph, char option, int vertex, ofstream *fout)
+bool DFS(Graph *graph, char option, int vertex, LogSink *fout)
 {
     int size = graph->getSize();
 
@@ -111,6 +131,7 @@ bool DFS(Graph *graph, char option, int vertex, ofstream *fout)
     vector<bool> visited(size, false);
     stack<int> S;
     vector<int> result;
+    vector<int> neighbors;
 
     // Visit start vertex
     S.push(vertex);
@@ -128,32 +149,23 @@ bool DFS(Graph *graph, char option, int vertex, ofstream *fout)
 
         visited[cur] = true;
         result.push_back(cur);
+        STAT_ADD(STAT_SETTLED, 1);
 
-        map<int, int> adj;
-        if (option == 'O')
-        {
-            graph->getAdjacentEdgesDirect(cur, &adj);
-        }
-        else
-        {
-            graph->getAdjacentEdges(cur, &adj);
-        }
-
-        // Collect neighbors to control visiting order
-        vector<int> neighbors;
-        for (auto &p : adj)
+        // Collect neighbors to control visiting order (already ascending)
+        neighbors.clear();
+        forEachEdge(graph, cur, option, [&](int next, int)
         {
-            neighbors.push_back(p.first);
-        }
+            STAT_ADD(STAT_RELAXED, 1);
+            neighbors.push_back(next);
+            return true;
+        });
 
-        sort(neighbors.begin(), neighbors.end(), greater<int>());
-
-        // Push unvisited negibors
-        for (int next : neighbors)
+        // Push unvisited negibors in descending order
+        for (int i = (int)neighbors.size() - 1; i >= 0; i--)
         {
-            if (!visited[next])
+            if (!visited[neighbors[i]])
             {
-                S.push(next);
+                S.push(neighbors[i]);
             }
         }
     }
@@ -172,14 +184,15 @@ bool DFS(Graph *graph, char option, int vertex, ofstream *fout)
     return true;
 }
 
-// Find root vertex
+// Find root vertex, halving the path without recursion
 int Find(vector<int> &parent, int x)
 {
-    if (parent[x] == x)
+    while (parent[x] != x)
     {
-        return x;
+        parent[x] = parent[parent[x]];
+        x = parent[x];
     }
-    return parent[x] = Find(parent, parent[x]);
+    return x;
 }
 
 // Make same union
@@ -194,67 +207,51 @@ void Union(vector<int> &parent, int a, int b)
 }
 
 // Build a MST using Kruskal
-bool Kruskal(Graph *graph, ofstream *fout)
+bool Kruskal(Graph *graph, LogSink *fout, const GraphProfile *profile, DynamicMst *state)
 {
     int size = graph->getSize();
+    vector<MstEdge> tree;
+    bool spanning;
 
-    vector<tuple<int, int, int>> edges;
-
-    // Collect all undirected edges
-    for (int u = 0; u < size; u++)
+    if (state && state->valid())
+    {
+        // Forest maintained across edge changes
+        spanning = state->tree(tree);
+    }
+    else
     {
-        map<int, int> adj;
-        graph->getAdjacentEdges(u, &adj);
+        // Engine follows density and thread count, every engine picks the same tree
+        MstKind kind = MST_AUTO;
+        if (profile)
+        {
+            kind = chooseMst(graph, profile->edges, defaultPool().size());
+        }
+        spanning = minimumSpanningTree(graph, kind, tree);
 
-        for (auto &p : adj)
+        if (state)
         {
-            int v = p.first, w = p.second;
-            if (u < v)
+            // Kruskal still leaves the whole forest when the graph is not connected
+            if (!spanning)
             {
-                edges.push_back({w, u, v});
+                filterKruskal(graph, tree);
             }
+            state->assign(size, tree);
         }
     }
 
-    // Can't make MST
-    if (edges.empty())
+    // Can't make MST (no edges or not connected)
+    if (!spanning)
     {
         return false;
     }
 
-    // Sort all edges by weight
-    sort(edges.begin(), edges.end());
-
-    vector<int> parent(size);
-    for (int i = 0; i < size; i++)
-    {
-        parent[i] = i;
-    }
-
     vector<vector<pair<int, int>>> mst(size);
-    int total = 0, used = 0;
-
-    // Process edges in increasing weight order
-    for (auto &e : edges)
-    {
-        int w, u, v;
-        tie(w, u, v) = e;
-
-        if (Find(parent, u) != Find(parent, v))
-        {
-            Union(parent, u, v);
-            used++;
-
-            mst[u].push_back({v, w});
-            mst[v].push_back({u, w});
-            total += w;
-        }
-    }
-
-    // Check MST has (size - 1) edges
-    if (used != size - 1)
+    int total = 0;
+    for (auto &e : tree)
     {
-        return false;
+        mst[e.u].push_back({e.v, e.w});
+        mst[e.v].push_back({e.u, e.w});
+        total += e.w;
     }
 
     *fout << "========KRUSKAL========\n";
@@ -274,230 +271,315 @@ bool Kruskal(Graph *graph, ofstream *fout)
     return true;
 }
 
-// Compute shortest paths using Dijkstra
-bool Dijkstra(Graph *graph, char option, int vertex, ofstream *fout)
+// Dijkstra main loop, Queue is one of the IntQueue classes
+template <class Queue>
+static void runDijkstra(Graph *graph, char option, int vertex, int maxWeight, vector<int> &dist, vector<int> &prev, QueueStats *stats)
 {
-    int size = graph->getSize();
-
-    if (vertex < 0 || vertex >= size)
-    {
-        return false;
-    }
-
-    // Check negative edges
-    for (int u = 0; u < size; u++)
-    {
-        map<int, int> adj;
-        graph->getAdjacentEdgesDirect(u, &adj);
-        for (auto &p : adj)
-        {
-            if (p.second < 0)
-            {
-                return false;
-            }
-        }
-    }
-
-    vector<int> dist(size, INF);
-    vector<int> prev(size, -1);
-
-    // Min-heap priority queue
-    priority_queue<pair<int, int>, vector<pair<int, int>>, greater<pair<int, int>>> pq;
+    Queue pq(graph->getSize(), maxWeight);
 
     dist[vertex] = 0;
-    pq.push({0, vertex});
+    pq.push(0, vertex);
 
     while (!pq.empty())
     {
-        auto top = pq.top();
-        pq.pop();
-
-        int cost = top.first;
-        int cur = top.second;
+        int cost;
+        int cur = pq.pop(cost);
 
         // Skip outdated entries
-        if (cost > dist[cur])
+        if (Queue::lazy && cost > dist[cur])
         {
             continue;
         }
 
-        // Get adjacency based on option
-        map<int, int> adj;
-        if (option == 'O')
-        {
-            graph->getAdjacentEdgesDirect(cur, &adj);
-        }
-        else
-        {
-            graph->getAdjacentEdges(cur, &adj);
-        }
+        STAT_ADD(STAT_SETTLED, 1);
 
-        // Relax edges
-        for (auto &p : adj)
+        // Relax edges based on option
+        forEachEdge(graph, cur, option, [&](int next, int w)
         {
-            int next = p.first;
-            int w = p.second;
+            STAT_ADD(STAT_RELAXED, 1);
 
             // If find shorter path
             if (dist[next] > dist[cur] + w)
             {
                 dist[next] = dist[cur] + w;
                 prev[next] = cur;
-                pq.push({dist[next], next});
+                pq.push(dist[next], next);
             }
-        }
+            return true;
+        });
     }
 
-    *fout << "========DIJKSTRA========\n";
-    if (option == 'O')
+    STAT_ADD(STAT_PUSHES, pq.stats.pushes);
+    STAT_ADD(STAT_POPS, pq.stats.pops);
+    if (stats)
     {
-        *fout << "Directed Graph Dijkstra" << "\n";
+        *stats = pq.stats;
     }
-    else
+}
+
+// Number of characters in the decimal form of value >= 0
+static int decimalLength(int value)
+{
+    int length = 1;
+    while (value >= 10)
     {
-        *fout << "Undirected Graph Dijkstra" << "\n";
+        value /= 10;
+        length++;
     }
-    *fout << "Start: " << vertex << "\n";
+    return length;
+}
+
+// Write value >= 0 ending just before end, returns where it starts
+static char *writeDecimal(char *end, int value)
+{
+    do
+    {
+        *--end = (char)('0' + value % 10);
+        value /= 10;
+    } while (value);
+    return end;
+}
+
+// Upper bound on the bytes of path lines rendered at once
+static const size_t PATH_WINDOW = 1 << 22;
+
+// Print "[v] source -> ... -> v (dist)" (or "[v] x") for every vertex in order.
+// A vertex's path is its parent's path plus " -> v", so a DFS over the shortest-path
+// tree keeps the current root path as text and copies it into each line's slot.
+// Lines are rendered in windows of about PATH_WINDOW bytes to bound memory.
+static void printShortestPathTree(LogSink *fout, int source, const vector<int> &dist, const vector<int> &prev)
+{
+    int size = (int)dist.size();
 
+    // Children of each tree vertex, grouped by parent
+    vector<int> childStart(size + 1, 0);
     for (int v = 0; v < size; v++)
     {
-        *fout << "[" << v << "] ";
+        if (dist[v] != INF && v != source)
+            childStart[prev[v] + 1]++;
+    }
+    for (int v = 0; v < size; v++)
+    {
+        childStart[v + 1] += childStart[v];
+    }
+    vector<int> children(childStart[size]);
+    vector<int> fill(childStart.begin(), childStart.end() - 1);
+    for (int v = 0; v < size; v++)
+    {
+        if (dist[v] != INF && v != source)
+            children[fill[prev[v]]++] = v;
+    }
 
-        // Unreachable vertex
-        if (dist[v] == INF)
+    // Path text length of every reachable vertex, parents come first in DFS order
+    vector<long long> pathLength(size, 0);
+    vector<int> order;
+    order.reserve(size);
+    order.push_back(source);
+    pathLength[source] = decimalLength(source);
+    for (size_t i = 0; i < order.size(); i++)
+    {
+        int u = order[i];
+        for (int c = childStart[u]; c < childStart[u + 1]; c++)
         {
-            *fout << "x\n";
-            continue;
+            int v = children[c];
+            pathLength[v] = pathLength[u] + 4 + decimalLength(v);
+            order.push_back(v);
         }
+    }
 
-        // Start vertex
-        if (v == vertex)
-        {
-            *fout << v << " (0)\n";
-            continue;
-        }
+    // Full line length: "[v] " + (path + " (d)\n" or "x\n")
+    vector<long long> lineLength(size);
+    for (int v = 0; v < size; v++)
+    {
+        lineLength[v] = decimalLength(v) + 3;
+        if (dist[v] == INF)
+            lineLength[v] += 2;
+        else
+            lineLength[v] += pathLength[v] + 4 + decimalLength(dist[v]);
+    }
 
-        vector<int> path;
-        int cur = v;
+    vector<char> window;
+    vector<long long> slot(size);
+    string path;
+    vector<pair<int, int>> stack; // (vertex, next child index)
 
-        while (cur != -1)
+    for (int first = 0; first < size;)
+    {
+        // Vertices [first, last) fit in one window (always at least one)
+        int last = first;
+        long long bytes = 0;
+        while (last < size && (last == first || bytes + lineLength[last] <= (long long)PATH_WINDOW))
         {
-            path.push_back(cur);
-            cur = prev[cur];
+            slot[last] = bytes;
+            bytes += lineLength[last];
+            last++;
         }
+        window.resize(bytes);
 
-        reverse(path.begin(), path.end());
+        // Line heads and tails, the path text goes in between
+        bool anyPath = false;
+        for (int v = first; v < last; v++)
+        {
+            char *line = window.data() + slot[v];
+            char *end = line + lineLength[v];
+            line[0] = '[';
+            writeDecimal(line + 1 + decimalLength(v), v);
+            memcpy(line + 1 + decimalLength(v), "] ", 2);
 
-        for (int i = 0; i < path.size(); i++)
+            if (dist[v] == INF)
+            {
+                memcpy(end - 2, "x\n", 2);
+                continue;
+            }
+            anyPath = true;
+            memcpy(end - 2, ")\n", 2);
+            char *number = writeDecimal(end - 2, dist[v]);
+            memcpy(number - 2, " (", 2);
+        }
+
+        // DFS with the root path rendered in path
+        if (anyPath)
         {
-            *fout << path[i];
-            if (i != path.size() - 1)
-                *fout << " -> ";
+            char digits[16];
+            char *digitsEnd = digits + sizeof(digits);
+            char *number = writeDecimal(digitsEnd, source);
+
+            path.assign(number, digitsEnd);
+            stack.clear();
+            stack.push_back({source, childStart[source]});
+
+            while (!stack.empty())
+            {
+                int u = stack.back().first;
+                int &next = stack.back().second;
+
+                // Copy on first visit
+                if (next == childStart[u] && u >= first && u < last)
+                {
+                    memcpy(window.data() + slot[u] + decimalLength(u) + 3, path.data(), path.size());
+                }
+
+                if (next == childStart[u + 1])
+                {
+                    // Drop " -> u" on the way back up
+                    stack.pop_back();
+                    if (!stack.empty())
+                        path.resize(path.size() - 4 - decimalLength(u));
+                    continue;
+                }
+
+                int v = children[next++];
+                number = writeDecimal(digitsEnd, v);
+                path.append(" -> ");
+                path.append(number, digitsEnd);
+                stack.push_back({v, childStart[v]});
+            }
         }
-        *fout << " (" << dist[v] << ")\n";
-    }
 
-    *fout << "====================\n\n";
-    return true;
+        fout->write(window.data(), window.size());
+        first = last;
+    }
 }
 
-// Compute shortest path using Bellman-Ford
-bool Bellmanford(Graph *graph, char option, int s, int e, ofstream *fout)
+// Shortest-path tree from vertex using Dijkstra
+bool dijkstraTree(Graph *graph, char option, int vertex, vector<int> &dist, vector<int> &prev,
+                  const GraphProfile *profile, QueueStats *stats)
 {
     int size = graph->getSize();
 
-    // Check valid range
-    if (s < 0 || s >= size || e < 0 || e >= size)
+    if (vertex < 0 || vertex >= size)
     {
         return false;
     }
 
-    vector<tuple<int, int, int>> edges;
-
-    // Collect all edges
-    for (int u = 0; u < size; u++)
+    // Check negative edges (profile from LOAD, or scan now)
+    GraphProfile scanned;
+    if (!profile)
     {
-        map<int, int> adj;
-        if (option == 'O')
-        {
-            graph->getAdjacentEdgesDirect(u, &adj);
-        }
-        else
-        {
-            graph->getAdjacentEdges(u, &adj);
-        }
-
-        for (auto &p : adj)
-        {
-            edges.push_back({u, p.first, p.second});
-        }
+        scanned = profileGraph(graph);
+        profile = &scanned;
     }
-
-    vector<int> dist(size, INF);
-    vector<int> prev(size, -1);
-
-    dist[s] = 0;
-
-    // Relax edges up to (size - 1) times
-    for (int i = 0; i < size - 1; i++)
+    if (profile->minWeight < 0)
     {
-        bool updated = false;
-        for (auto &ed : edges)
-        {
-            int u, v, w;
-            tie(u, v, w) = ed;
-            if (dist[u] != INF && dist[v] > dist[u] + w)
-            {
-                dist[v] = dist[u] + w;
-                prev[v] = u;
-                updated = true;
-            }
-        }
-        // If there is no update, Early stop
-        if (!updated)
-        {
-            break;
-        }
+        return false;
     }
 
-    // Check negative cycle
-    for (auto &ed : edges)
+    dist.assign(size, INF);
+    prev.assign(size, -1);
+
+    // Integer priority queue picked from max weight and density
+    switch (chooseQueue(*profile, size))
     {
-        int u, v, w;
-        tie(u, v, w) = ed;
-        if (dist[u] != INF && dist[v] > dist[u] + w)
-        {
-            return false;
-        }
+    case QUEUE_BINARY:
+        runDijkstra<BinaryQueue>(graph, option, vertex, profile->maxWeight, dist, prev, stats);
+        break;
+    case QUEUE_DIAL:
+        runDijkstra<DialQueue>(graph, option, vertex, profile->maxWeight, dist, prev, stats);
+        break;
+    case QUEUE_DARY:
+        runDijkstra<DaryQueue>(graph, option, vertex, profile->maxWeight, dist, prev, stats);
+        break;
+    default:
+        runDijkstra<RadixQueue>(graph, option, vertex, profile->maxWeight, dist, prev, stats);
+        break;
     }
+    return true;
+}
 
-    *fout << "========BELLMANFORD========\n";
+void printDijkstra(LogSink *fout, char option, int vertex, const vector<int> &dist, const vector<int> &prev)
+{
+    *fout << "========DIJKSTRA========\n";
     if (option == 'O')
     {
-        *fout << "Directed Graph Bellman-Ford" << "\n";
+        *fout << "Directed Graph Dijkstra" << "\n";
     }
     else
     {
-        *fout << "Undirected Graph Bellman-Ford" << "\n";
+        *fout << "Undirected Graph Dijkstra" << "\n";
     }
-    // If end vertex is unreachable
-    if (dist[e] == INF)
+    *fout << "Start: " << vertex << "\n";
+
+    printShortestPathTree(fout, vertex, dist, prev);
+
+    *fout << "====================\n\n";
+}
+
+// Compute shortest paths using Dijkstra
+bool Dijkstra(Graph *graph, char option, int vertex, LogSink *fout, const GraphProfile *profile, QueueStats *stats,
+              QueryWorkspace *ws)
+{
+    // Batches pass a workspace so the vectors keep their storage between queries
+    QueryWorkspace local;
+    if (!ws)
     {
-        *fout << "x\n";
-        *fout << "Cost: x\n";
-        *fout << "====================\n\n";
-        return true;
+        ws = &local;
     }
 
-    vector<int> path;
-    int cur = e;
-    while (cur != -1)
+    if (!dijkstraTree(graph, option, vertex, ws->dist, ws->prev, profile, stats))
     {
-        path.push_back(cur);
-        cur = prev[cur];
+        return false;
     }
 
-    reverse(path.begin(), path.end());
+    printDijkstra(fout, option, vertex, ws->dist, ws->prev);
+    return true;
+}
+
+// Shortest paths from s allowing negative weights, returns false on negative cycle
+static bool bellmanfordSearch(Graph *graph, char option, int s, vector<int> &dist, vector<int> &prev)
+{
+    // Worklist Bellman-Ford, prev identical to sweeping every edge each round
+    return bellmanfordTree(graph, option, s, dist, prev);
+}
+
+// Print "a -> b -> c" and its cost, or x when there is no path
+static void printPath(LogSink *fout, const vector<int> &path, long long cost)
+{
+    if (path.empty())
+    {
+        *fout << "x\n";
+        *fout << "Cost: x\n";
+        return;
+    }
 
     for (int i = 0; i < path.size(); i++)
     {
@@ -505,64 +587,174 @@ bool Bellmanford(Graph *graph, char option, int s, int e, ofstream *fout)
         if (i != path.size() - 1)
             *fout << " -> ";
     }
-    *fout << "\nCost: " << dist[e] << "\n";
-    *fout << "====================\n\n";
+    *fout << "\nCost: " << cost << "\n";
+}
 
-    return true;
+// Walk prev links back from e
+static void tracePath(const vector<int> &prev, int e, vector<int> &path)
+{
+    path.clear();
+    for (int cur = e; cur != -1; cur = prev[cur])
+    {
+        path.push_back(cur);
+    }
+    reverse(path.begin(), path.end());
 }
 
-// Compute all-pairs shortest paths using Floyd
-bool FLOYD(Graph *graph, char option, ofstream *fout)
+// Answer s -> e from a cached all-pairs matrix when no path has to be rebuilt:
+// e unreachable or e == s. Other pairs still run the tree search for the exact path.
+static bool cachedPath(ApspCache *cache, char option, int s, int e, vector<int> &path, long long &cost)
+{
+    int d;
+    if (!cache || !cache->lookup(option, s, e, d))
+    {
+        return false;
+    }
+
+    path.clear();
+    cost = 0;
+    if (d >= INF)
+    {
+        return true;
+    }
+    if (s == e)
+    {
+        path.push_back(s);
+        return true;
+    }
+    return false;
+}
+
+// Compute shortest path using Bellman-Ford
+bool Bellmanford(Graph *graph, char option, int s, int e, LogSink *fout, QueryWorkspace *ws, ApspCache *cache)
 {
     int size = graph->getSize();
-    vector<vector<int>> dist(size, vector<int>(size, INF));
 
-    for (int u = 0; u < size; u++)
+    // Check valid range
+    if (s < 0 || s >= size || e < 0 || e >= size)
     {
-        map<int, int> adj;
-        if (option == 'O')
-        {
-            graph->getAdjacentEdgesDirect(u, &adj);
-        }
-        else
-        {
-            graph->getAdjacentEdges(u, &adj);
-        }
+        return false;
+    }
+
+    QueryWorkspace local;
+    if (!ws)
+    {
+        ws = &local;
+    }
+    vector<int> &dist = ws->dist, &prev = ws->prev, &path = ws->path;
+    long long cost = 0;
+    bool cached = cachedPath(cache, option, s, e, path, cost);
+    if (!cached && !bellmanfordSearch(graph, option, s, dist, prev))
+    {
+        return false;
+    }
 
-        for (auto &p : adj)
+    *fout << "========BELLMANFORD========\n";
+    if (option == 'O')
+    {
+        *fout << "Directed Graph Bellman-Ford" << "\n";
+    }
+    else
+    {
+        *fout << "Undirected Graph Bellman-Ford" << "\n";
+    }
+
+    // If end vertex is unreachable, path stays empty
+    if (!cached)
+    {
+        path.clear();
+        if (dist[e] != INF)
         {
-            dist[u][p.first] = p.second;
+            tracePath(prev, e, path);
         }
+        cost = dist[e];
     }
+    printPath(fout, path, cost);
+    *fout << "====================\n\n";
 
-    // Consider self-loop
-    for (int i = 0; i < size; i++)
+    return true;
+}
+
+// Shortest s -> e path, bidirectional Dijkstra or Bellman-Ford with negative edges
+bool PathQuery(Graph *graph, char option, int s, int e, LogSink *fout, const GraphProfile *profile, ApspCache *cache)
+{
+    int size = graph->getSize();
+
+    // Check valid range
+    if (s < 0 || s >= size || e < 0 || e >= size)
+    {
+        return false;
+    }
+
+    GraphProfile scanned;
+    if (!profile)
     {
-        dist[i][i] = min(dist[i][i], 0);
+        scanned = profileGraph(graph);
+        profile = &scanned;
     }
 
-    for (int k = 0; k < size; k++)
+    vector<int> path;
+    long long cost = 0;
+    if (cachedPath(cache, option, s, e, path, cost))
+    {
+        // Unreachable or e == s, known from an earlier FLOYD without searching
+    }
+    else if (profile->minWeight >= 0)
     {
-        for (int i = 0; i < size; i++)
+        // Both searches stop as soon as the best meeting cost is final
+        bidirectionalDijkstra(graph, option, s, e, path, cost);
+    }
+    else
+    {
+        // Negative edges need Bellman-Ford
+        vector<int> dist, prev;
+        if (!bellmanfordSearch(graph, option, s, dist, prev))
         {
-            for (int j = 0; j < size; j++)
-            {
-                if (dist[i][k] < INF && dist[k][j] < INF)
-                {
-                    dist[i][j] = min(dist[i][j], dist[i][k] + dist[k][j]);
-                }
-            }
+            return false;
+        }
+        if (dist[e] != INF)
+        {
+            tracePath(prev, e, path);
+            cost = dist[e];
         }
     }
 
-    // Check negative cycle
-    for (int i = 0; i < size; i++)
+    *fout << "========PATH========\n";
+    if (option == 'O')
+    {
+        *fout << "Directed Graph Path" << "\n";
+    }
+    else
     {
-        if (dist[i][i] < 0)
+        *fout << "Undirected Graph Path" << "\n";
+    }
+    printPath(fout, path, cost);
+    *fout << "====================\n\n";
+
+    return true;
+}
+
+// Compute all-pairs shortest paths using Floyd
+bool FLOYD(Graph *graph, char option, LogSink *fout, ApspCache *cache)
+{
+    int size = graph->getSize();
+    vector<int> local;
+    const vector<int> *cached = nullptr;
+
+    // Tiled Floyd-Warshall (or the cached result), fails on negative cycle
+    if (cache)
+    {
+        cached = cache->matrix(graph, option);
+        if (!cached)
         {
             return false;
         }
     }
+    else if (!blockedFloyd(graph, option, local))
+    {
+        return false;
+    }
+    const vector<int> &dist = cached ? *cached : local;
 
     *fout << "========FLOYD========\n";
     if (option == 'O')
@@ -584,15 +776,16 @@ bool FLOYD(Graph *graph, char option, ofstream *fout)
     for (int i = 0; i < size; i++)
     {
         *fout << "[" << i << "] ";
+        const int *row = &dist[(size_t)i * size];
         for (int j = 0; j < size; j++)
         {
-            if (dist[i][j] >= INF)
+            if (row[j] >= INF)
             {
                 *fout << "x   ";
             }
             else
             {
-                *fout << dist[i][j] << "   ";
+                *fout << row[j] << "   ";
             }
         }
         *fout << "\n";
@@ -603,50 +796,26 @@ bool FLOYD(Graph *graph, char option, ofstream *fout)
 }
 
 // Compute closeness centrality
-bool Centrality(Graph *graph, ofstream *fout)
+bool Centrality(Graph *graph, LogSink *fout, ApspCache *cache)
 {
     int n = graph->getSize();
+    vector<DistanceSum> local;
+    const vector<DistanceSum> *cached = nullptr;
 
-    vector<vector<int>> dist(n, vector<int>(n, INF));
-
-    // Initialize
-    for (int u = 0; u < n; u++)
-    {
-        map<int, int> adj;
-        graph->getAdjacentEdges(u, &adj);
-        for (auto &p : adj)
-            dist[u][p.first] = p.second;
-    }
-
-    // Consider self-loop
-    for (int i = 0; i < n; i++)
+    // Distance sum of every vertex from parallel single-source searches (or the cache)
+    if (cache)
     {
-        dist[i][i] = min(dist[i][i], 0);
-    }
-
-    // Run Floyd to compute all-pairs shortest paths
-    for (int k = 0; k < n; k++)
-    {
-        for (int i = 0; i < n; i++)
+        cached = cache->distanceSums(graph);
+        if (!cached)
         {
-            for (int j = 0; j < n; j++)
-            {
-                if (dist[i][k] < INF && dist[k][j] < INF)
-                {
-                    dist[i][j] = min(dist[i][j], dist[i][k] + dist[k][j]);
-                }
-            }
+            return false;
         }
     }
-
-    // Check negative cycle
-    for (int i = 0; i < n; i++)
+    else if (!allSourceDistanceSums(graph, 'X', local))
     {
-        if (dist[i][i] < 0)
-        {
-            return false;
-        }
+        return false;
     }
+    const vector<DistanceSum> &rows = cached ? *cached : local;
 
     vector<double> close(n);
     vector<bool> unreachable(n, false);
@@ -655,30 +824,14 @@ bool Centrality(Graph *graph, ofstream *fout)
     // Compute closeness centrality
     for (int i = 0; i < n; i++)
     {
-        long long sum = 0;
-        bool unreachable_flag = false;
-        for (int j = 0; j < n; j++)
-        {
-            if (i == j)
-            {
-                continue;
-            }
-            if (dist[i][j] == INF)
-            {
-                unreachable_flag = true;
-                break;
-            }
-            sum += dist[i][j];
-        }
-
-        if (unreachable_flag)
+        if (!rows[i].reachAll)
         {
             unreachable[i] = true;
         }
         else
         {
-            denom[i] = sum;
-            close[i] = double(n - 1) / sum;
+            denom[i] = rows[i].sum;
+            close[i] = double(n - 1) / rows[i].sum;
         }
     }
 
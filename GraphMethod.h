@@ -3,14 +3,37 @@
 
 #include "ListGraph.h"
 #include "MatrixGraph.h"
+#include "CsrGraph.h"
+#include "ApspCache.h"
+#include "IntQueue.h"
+#include "DynamicMst.h"
 
-bool BFS(Graph *graph, char option, int vertex, ofstream *fout);
-bool DFS(Graph *graph, char option, int vertex, ofstream *fout);
-bool Centrality(Graph *graph, ofstream *fout);
-bool Kruskal(Graph *graph, ofstream *fout);
-bool Dijkstra(Graph *graph, char option, int vertex, ofstream *fout);                    // Dijkstra
-bool Bellmanford(Graph *graph, char option, int s_vertex, int e_vertex, ofstream *fout); // Bellman - Ford
-bool FLOYD(Graph *graph, char option, ofstream *fout);                                   // FLoyd
+// Buffers one thread reuses across the queries of a batch
+struct QueryWorkspace
+{
+	vector<int> dist;
+	vector<int> prev;
+	vector<int> path;
+	QueueStats stats;
+};
+
+bool BFS(Graph *graph, char option, int vertex, LogSink *fout);
+bool DFS(Graph *graph, char option, int vertex, LogSink *fout);
+bool Reach(Graph *graph, char option, int vertex, LogSink *fout);                       // Reachable set with hop levels
+bool Centrality(Graph *graph, LogSink *fout, ApspCache *cache = nullptr);   // Uses cache when given
+bool Kruskal(Graph *graph, LogSink *fout, const GraphProfile *profile = nullptr,
+             DynamicMst *state = nullptr);                                            // MST engine chosen from profile, state kept when given
+bool Dijkstra(Graph *graph, char option, int vertex, LogSink *fout,
+              const GraphProfile *profile = nullptr, QueueStats *stats = nullptr,
+              QueryWorkspace *ws = nullptr);                                            // Dijkstra, queue chosen from profile
+bool dijkstraTree(Graph *graph, char option, int vertex, vector<int> &dist, vector<int> &prev,
+                  const GraphProfile *profile = nullptr, QueueStats *stats = nullptr); // Dijkstra without output
+void printDijkstra(LogSink *fout, char option, int vertex, const vector<int> &dist, const vector<int> &prev);
+bool Bellmanford(Graph *graph, char option, int s_vertex, int e_vertex, LogSink *fout,
+                 QueryWorkspace *ws = nullptr, ApspCache *cache = nullptr);             // Bellman - Ford, uses cache when given
+bool PathQuery(Graph *graph, char option, int s_vertex, int e_vertex, LogSink *fout,
+               const GraphProfile *profile = nullptr, ApspCache *cache = nullptr);      // Point-to-point path, uses cache when given
+bool FLOYD(Graph *graph, char option, LogSink *fout, ApspCache *cache = nullptr);        // FLoyd, uses cache when given
 int Find(vector<int> &parent, int x);
 void Union(vector<int> &parent, int a, int b);
 
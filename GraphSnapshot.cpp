@@ -0,0 +1,251 @@
+#include "GraphSnapshot.h"
+#include "GraphLoader.h"
+#include "CsrGraph.h"
+#include "ThreadPool.h"
+#include <cstdio>
+#include <climits>
+
+static const char SNAPSHOT_MAGIC[8] = {'D', 'S', 'G', 'R', 'A', 'P', 'H', '\0'};
+static const unsigned int SNAPSHOT_VERSION = 1;
+static const unsigned int SNAPSHOT_BYTE_ORDER = 0x01020304;
+
+// Checksum block in ints, blocks are hashed independently then folded in order
+static const size_t CHECKSUM_BLOCK = 1 << 18;
+
+static const unsigned long long HASH_SEED = 14695981039346656037ULL;
+static const unsigned long long HASH_PRIME = 1099511628211ULL;
+
+// FNV-1a over 32-bit words
+static unsigned long long hashWords(const int *words, size_t count)
+{
+    unsigned long long h = HASH_SEED;
+    for (size_t i = 0; i < count; i++)
+    {
+        h = (h ^ (unsigned int)words[i]) * HASH_PRIME;
+    }
+    return h;
+}
+
+// Hash of each CHECKSUM_BLOCK words folded with FNV-1a, blocks run on defaultPool()
+static unsigned long long checksumWords(const int *words, size_t count)
+{
+    int blocks = (int)((count + CHECKSUM_BLOCK - 1) / CHECKSUM_BLOCK);
+    vector<unsigned long long> part(blocks);
+
+    defaultPool().parallelFor(blocks, [&](int b, int)
+    {
+        size_t first = (size_t)b * CHECKSUM_BLOCK;
+        part[b] = hashWords(words + first, min(CHECKSUM_BLOCK, count - first));
+    });
+
+    unsigned long long h = HASH_SEED;
+    for (int b = 0; b < blocks; b++)
+    {
+        h = (h ^ part[b]) * HASH_PRIME;
+    }
+    return h;
+}
+
+// Collects one direction of the graph as CSR arrays
+static void collectRows(Graph *graph, bool incoming, vector<int> &payload)
+{
+    int size = graph->getSize();
+
+    size_t offsetAt = payload.size();
+    payload.resize(offsetAt + size + 1);
+    payload[offsetAt] = 0;
+    for (int v = 0; v < size; v++)
+    {
+        int degree = incoming ? graph->inDegree(v) : graph->outDegree(v);
+        payload[offsetAt + v + 1] = payload[offsetAt + v] + degree;
+    }
+
+    int edges = payload[offsetAt + size];
+    size_t ends = payload.size();
+    size_t weights = ends + edges;
+    payload.resize(ends + 2 * (size_t)edges);
+
+    size_t slot = 0;
+    for (int v = 0; v < size; v++)
+    {
+        auto store = [&](int other, int weight)
+        {
+            payload[ends + slot] = other;
+            payload[weights + slot] = weight;
+            slot++;
+            return true;
+        };
+        if (incoming)
+            forEachReverseEdge(graph, v, 'O', store);
+        else
+            forEachEdge(graph, v, 'O', store);
+    }
+}
+
+bool saveSnapshot(Graph *graph, const char *path)
+{
+    vector<int> payload;
+    collectRows(graph, false, payload);
+    collectRows(graph, true, payload);
+
+    SnapshotHeader header;
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.byteOrder = SNAPSHOT_BYTE_ORDER;
+    header.type = graph->getType() ? 1 : 0;
+    header.size = graph->getSize();
+    header.edges = payload[header.size];
+    header.checksum = checksumWords(payload.data(), payload.size());
+
+    FILE *out = fopen(path, "wb");
+    if (out == nullptr)
+    {
+        return false;
+    }
+
+    bool ok = fwrite(&header, sizeof(header), 1, out) == 1 &&
+              fwrite(payload.data(), sizeof(int), payload.size(), out) == payload.size();
+    ok = fclose(out) == 0 && ok;
+    return ok;
+}
+
+bool isSnapshot(const char *data, size_t size)
+{
+    return size >= sizeof(SNAPSHOT_MAGIC) && memcmp(data, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) == 0;
+}
+
+// Offsets must start at 0, never decrease and end at edges
+static bool validOffsets(const int *offset, int size, long long edges)
+{
+    if (offset[0] != 0 || offset[size] != edges)
+        return false;
+    for (int v = 0; v < size; v++)
+    {
+        if (offset[v] > offset[v + 1])
+            return false;
+    }
+    return true;
+}
+
+// Every endpoint is a vertex
+static bool validEndpoints(const int *ends, long long edges, int size)
+{
+    int blocks = (int)((edges + CHECKSUM_BLOCK - 1) / CHECKSUM_BLOCK);
+    vector<char> ok(blocks, 1);
+
+    defaultPool().parallelFor(blocks, [&](int b, int)
+    {
+        long long first = (long long)b * CHECKSUM_BLOCK;
+        long long last = min(edges, first + (long long)CHECKSUM_BLOCK);
+        for (long long e = first; e < last; e++)
+        {
+            if ((unsigned)ends[e] >= (unsigned)size)
+            {
+                ok[b] = 0;
+                return;
+            }
+        }
+    });
+
+    for (int b = 0; b < blocks; b++)
+    {
+        if (!ok[b])
+            return false;
+    }
+    return true;
+}
+
+// Rows strictly ascending, CsrGraph binary-searches them
+static bool sortedRows(const int *offset, const int *ends, int size)
+{
+    int blocks = (int)((size + CHECKSUM_BLOCK - 1) / CHECKSUM_BLOCK);
+    vector<char> ok(blocks, 1);
+
+    defaultPool().parallelFor(blocks, [&](int b, int)
+    {
+        int first = (int)(b * CHECKSUM_BLOCK);
+        int last = (int)min((size_t)size, first + CHECKSUM_BLOCK);
+        for (int v = first; v < last; v++)
+        {
+            for (int e = offset[v] + 1; e < offset[v + 1]; e++)
+            {
+                if (ends[e - 1] >= ends[e])
+                {
+                    ok[b] = 0;
+                    return;
+                }
+            }
+        }
+    });
+
+    for (int b = 0; b < blocks; b++)
+    {
+        if (!ok[b])
+            return false;
+    }
+    return true;
+}
+
+// Incoming arrays must be the exact transpose of the outgoing ones: taking sources in
+// ascending order, edge u -> v (w) is always the next unread slot of row v
+static bool validTranspose(const int *out, const int *in, int size, long long edges)
+{
+    const int *target = out + size + 1, *weight = target + edges;
+    const int *inOffset = in, *source = in + size + 1, *inWeight = source + edges;
+
+    vector<int> next(inOffset, inOffset + size);
+    for (int u = 0; u < size; u++)
+    {
+        for (int e = out[u]; e < out[u + 1]; e++)
+        {
+            int v = target[e];
+            int slot = next[v]++;
+            if (slot >= inOffset[v + 1] || source[slot] != u || inWeight[slot] != weight[e])
+                return false;
+        }
+    }
+    // Equal totals and no overflowing row leave every row read to its end
+    return true;
+}
+
+Graph *openSnapshot(MappedFile *file)
+{
+    const char *data = file->data();
+    size_t length = file->size();
+
+    SnapshotHeader header;
+    if (length < sizeof(header))
+    {
+        delete file;
+        return nullptr;
+    }
+    memcpy(&header, data, sizeof(header));
+
+    // Header must describe exactly the bytes that follow
+    bool ok = header.version == SNAPSHOT_VERSION && header.byteOrder == SNAPSHOT_BYTE_ORDER &&
+              (header.type == 0 || header.type == 1) && header.size > 0 &&
+              header.edges >= 0 && header.edges <= INT_MAX;
+    size_t words = 2 * ((size_t)header.size + 1) + 4 * (size_t)header.edges;
+    ok = ok && length - sizeof(header) == words * sizeof(int);
+
+    const int *arrays = (const int *)(data + sizeof(header));
+    if (ok)
+    {
+        const int *inOffset = arrays + header.size + 1 + 2 * header.edges;
+        ok = checksumWords(arrays, words) == header.checksum &&
+             validOffsets(arrays, header.size, header.edges) &&
+             validOffsets(inOffset, header.size, header.edges) &&
+             validEndpoints(arrays + header.size + 1, header.edges, header.size) &&
+             validEndpoints(inOffset + header.size + 1, header.edges, header.size) &&
+             sortedRows(arrays, arrays + header.size + 1, header.size) &&
+             validTranspose(arrays, inOffset, header.size, header.edges);
+    }
+
+    if (!ok)
+    {
+        delete file;
+        return nullptr;
+    }
+
+    return new CsrGraph(header.type == 1, header.size, (int)header.edges, arrays, file);
+}
@@ -0,0 +1,36 @@
+#ifndef _GRAPHSNAPSHOT_H_
+#define _GRAPHSNAPSHOT_H_
+
+#include "Graph.h"
+#include <cstddef>
+
+class MappedFile;
+
+// Binary snapshot layout (native byte order, checked through byteOrder):
+//   SnapshotHeader
+//   int offsets[size + 1], targets[edges], weights[edges]		outgoing CSR
+//   int inOffsets[size + 1], sources[edges], inWeights[edges]	incoming CSR
+// checksum covers everything after the header.
+struct SnapshotHeader
+{
+	char magic[8];				// "DSGRAPH\0"
+	unsigned int version;
+	unsigned int byteOrder;		// 0x01020304 as written
+	int type;					// 1 = L (list print), 0 = M (matrix print)
+	int size;
+	long long edges;
+	unsigned long long checksum;
+};
+
+// Writes graph to path in the snapshot format. Returns false on I/O errors.
+bool saveSnapshot(Graph *graph, const char *path);
+
+// True when data starts with the snapshot magic
+bool isSnapshot(const char *data, size_t size);
+
+// Read-only CsrGraph over the mapped arrays, nothing is parsed or copied.
+// Takes ownership of file. Returns nullptr when the version, sizes,
+// checksum or offsets do not check out.
+Graph *openSnapshot(MappedFile *file);
+
+#endif
@@ -0,0 +1,338 @@
+#include "IntQueue.h"
+#include <cstdlib>
+#include <string>
+
+// Largest max weight for which Dial's buckets are used
+static const int DIAL_MAX_WEIGHT = 1024;
+
+GraphProfile profileGraph(Graph *graph)
+{
+    GraphProfile profile = {0, 0, 0, 0, 0};
+    bool first = true;
+
+    // Scan every directed edge once
+    for (int u = 0; u < graph->getSize(); u++)
+    {
+        forEachEdge(graph, u, 'O', [&](int, int w)
+        {
+            if (first || w < profile.minWeight)
+            {
+                profile.minWeight = w;
+                profile.minCount = 0;
+            }
+            if (first || w > profile.maxWeight)
+            {
+                profile.maxWeight = w;
+                profile.maxCount = 0;
+            }
+            first = false;
+            profile.minCount += w == profile.minWeight;
+            profile.maxCount += w == profile.maxWeight;
+            profile.edges++;
+            return true;
+        });
+    }
+    return profile;
+}
+
+void updateProfile(GraphProfile &profile, Graph *graph, bool removed, int oldWeight, bool added, int newWeight)
+{
+    // Losing the last edge of an extreme weight needs a rescan to find the next one
+    if (removed && ((oldWeight == profile.minWeight && profile.minCount == 1) ||
+                    (oldWeight == profile.maxWeight && profile.maxCount == 1)))
+    {
+        profile = profileGraph(graph);
+        return;
+    }
+
+    if (removed)
+    {
+        profile.edges--;
+        profile.minCount -= oldWeight == profile.minWeight;
+        profile.maxCount -= oldWeight == profile.maxWeight;
+    }
+    if (added)
+    {
+        if (profile.edges == 0 || newWeight < profile.minWeight)
+        {
+            profile.minWeight = newWeight;
+            profile.minCount = 0;
+        }
+        if (profile.edges == 0 || newWeight > profile.maxWeight)
+        {
+            profile.maxWeight = newWeight;
+            profile.maxCount = 0;
+        }
+        profile.minCount += newWeight == profile.minWeight;
+        profile.maxCount += newWeight == profile.maxWeight;
+        profile.edges++;
+    }
+}
+
+QueueKind chooseQueue(const GraphProfile &profile, int size)
+{
+    // Manual override
+    const char *env = getenv("DS_DIJKSTRA_QUEUE");
+    if (env)
+    {
+        string name(env);
+        if (name == "binary")
+            return QUEUE_BINARY;
+        if (name == "dial")
+            return QUEUE_DIAL;
+        if (name == "radix")
+            return QUEUE_RADIX;
+        if (name == "dary")
+            return QUEUE_DARY;
+    }
+
+    // Dense graphs queue up to V^2 lazy entries, decrease-key keeps it at V
+    if (profile.edges >= (long long)size * size / 4)
+        return QUEUE_DARY;
+    if (profile.maxWeight <= DIAL_MAX_WEIGHT)
+        return QUEUE_DIAL;
+    return QUEUE_RADIX;
+}
+
+const char *queueName(QueueKind kind)
+{
+    switch (kind)
+    {
+    case QUEUE_BINARY:
+        return "binary";
+    case QUEUE_DIAL:
+        return "dial";
+    case QUEUE_RADIX:
+        return "radix";
+    case QUEUE_DARY:
+        return "dary";
+    default:
+        return "auto";
+    }
+}
+
+// Orders (key, vertex) pairs and plain vertices as min-heaps
+static greater<pair<int, int>> laterPair;
+static greater<int> laterVertex;
+
+BinaryQueue::BinaryQueue(int, int)
+{
+    stats.pushes = stats.pops = stats.decreases = 0;
+}
+
+void BinaryQueue::push(int key, int vertex)
+{
+    stats.pushes++;
+    m_Heap.push_back(make_pair(key, vertex));
+    push_heap(m_Heap.begin(), m_Heap.end(), laterPair);
+}
+
+int BinaryQueue::pop(int &key)
+{
+    stats.pops++;
+    pop_heap(m_Heap.begin(), m_Heap.end(), laterPair);
+    key = m_Heap.back().first;
+    int vertex = m_Heap.back().second;
+    m_Heap.pop_back();
+    return vertex;
+}
+
+DialQueue::DialQueue(int, int maxWeight)
+{
+    stats.pushes = stats.pops = stats.decreases = 0;
+    m_Width = maxWeight + 1;
+    m_Bucket.resize(m_Width);
+    m_Cur = 0;
+    m_Count = 0;
+}
+
+void DialQueue::push(int key, int vertex)
+{
+    stats.pushes++;
+    // Keys stay within [m_Cur, m_Cur + maxWeight], so buckets never collide
+    vector<int> &bucket = m_Bucket[key % m_Width];
+    bucket.push_back(vertex);
+    push_heap(bucket.begin(), bucket.end(), laterVertex);
+    m_Count++;
+}
+
+int DialQueue::pop(int &key)
+{
+    stats.pops++;
+    // Advance to the next non-empty bucket
+    while (m_Bucket[m_Cur % m_Width].empty())
+        m_Cur++;
+
+    vector<int> &bucket = m_Bucket[m_Cur % m_Width];
+    pop_heap(bucket.begin(), bucket.end(), laterVertex);
+    int vertex = bucket.back();
+    bucket.pop_back();
+    m_Count--;
+
+    key = m_Cur;
+    return vertex;
+}
+
+RadixQueue::RadixQueue(int, int)
+{
+    stats.pushes = stats.pops = stats.decreases = 0;
+    m_Last = 0;
+    m_Count = 0;
+}
+
+int RadixQueue::bucketOf(unsigned key, unsigned last)
+{
+    return key == last ? 0 : 32 - __builtin_clz(key ^ last);
+}
+
+void RadixQueue::push(int key, int vertex)
+{
+    stats.pushes++;
+    int b = bucketOf((unsigned)key, m_Last);
+    if (b == 0)
+    {
+        m_Same.push_back(vertex);
+        push_heap(m_Same.begin(), m_Same.end(), laterVertex);
+    }
+    else
+    {
+        m_Bucket[b].push_back(make_pair(key, vertex));
+    }
+    m_Count++;
+}
+
+int RadixQueue::pop(int &key)
+{
+    stats.pops++;
+    if (m_Same.empty())
+    {
+        // Smallest key lives in the lowest non-empty bucket
+        int b = 1;
+        while (m_Bucket[b].empty())
+            b++;
+
+        unsigned low = (unsigned)m_Bucket[b][0].first;
+        for (auto &entry : m_Bucket[b])
+            low = min(low, (unsigned)entry.first);
+
+        // Redistribute relative to the new minimum, every entry moves to a lower bucket
+        m_Last = low;
+        vector<pair<int, int>> moving;
+        moving.swap(m_Bucket[b]);
+        for (auto &entry : moving)
+        {
+            int nb = bucketOf((unsigned)entry.first, m_Last);
+            if (nb == 0)
+                m_Same.push_back(entry.second);
+            else
+                m_Bucket[nb].push_back(entry);
+        }
+        make_heap(m_Same.begin(), m_Same.end(), laterVertex);
+
+        // Hand the storage back to avoid reallocating later
+        moving.clear();
+        if (m_Bucket[b].empty())
+            m_Bucket[b].swap(moving);
+    }
+
+    pop_heap(m_Same.begin(), m_Same.end(), laterVertex);
+    int vertex = m_Same.back();
+    m_Same.pop_back();
+    m_Count--;
+
+    key = (int)m_Last;
+    return vertex;
+}
+
+DaryQueue::DaryQueue(int size, int)
+{
+    stats.pushes = stats.pops = stats.decreases = 0;
+    m_Pos.assign(size, -1);
+    m_Key.assign(size, 0);
+}
+
+bool DaryQueue::less(int a, int b)
+{
+    return m_Key[a] < m_Key[b] || (m_Key[a] == m_Key[b] && a < b);
+}
+
+void DaryQueue::siftUp(int slot)
+{
+    int vertex = m_Heap[slot];
+    while (slot > 0)
+    {
+        int parent = (slot - 1) / 4;
+        if (!less(vertex, m_Heap[parent]))
+            break;
+        m_Heap[slot] = m_Heap[parent];
+        m_Pos[m_Heap[slot]] = slot;
+        slot = parent;
+    }
+    m_Heap[slot] = vertex;
+    m_Pos[vertex] = slot;
+}
+
+void DaryQueue::siftDown(int slot)
+{
+    int size = (int)m_Heap.size();
+    int vertex = m_Heap[slot];
+    while (true)
+    {
+        // Pick the smallest of up to four children
+        int first = slot * 4 + 1;
+        if (first >= size)
+            break;
+        int best = first;
+        for (int c = first + 1; c < first + 4 && c < size; c++)
+        {
+            if (less(m_Heap[c], m_Heap[best]))
+                best = c;
+        }
+        if (!less(m_Heap[best], vertex))
+            break;
+        m_Heap[slot] = m_Heap[best];
+        m_Pos[m_Heap[slot]] = slot;
+        slot = best;
+    }
+    m_Heap[slot] = vertex;
+    m_Pos[vertex] = slot;
+}
+
+void DaryQueue::push(int key, int vertex)
+{
+    if (m_Pos[vertex] >= 0)
+    {
+        // Already queued, lower its key in place
+        if (key < m_Key[vertex])
+        {
+            stats.decreases++;
+            m_Key[vertex] = key;
+            siftUp(m_Pos[vertex]);
+        }
+        return;
+    }
+
+    stats.pushes++;
+    m_Key[vertex] = key;
+    m_Heap.push_back(vertex);
+    siftUp((int)m_Heap.size() - 1);
+}
+
+int DaryQueue::pop(int &key)
+{
+    stats.pops++;
+    int vertex = m_Heap[0];
+    key = m_Key[vertex];
+    m_Pos[vertex] = -1;
+
+    // Move the last vertex to the root and restore the heap
+    int last = m_Heap.back();
+    m_Heap.pop_back();
+    if (!m_Heap.empty())
+    {
+        m_Heap[0] = last;
+        m_Pos[last] = 0;
+        siftDown(0);
+    }
+    return vertex;
+}
@@ -0,0 +1,125 @@
+#ifndef _INTQUEUE_H_
+#define _INTQUEUE_H_
+
+#include "Graph.h"
+
+// Min-priority queues on non-negative int keys for Dijkstra.
+// All of them pop in ascending (key, vertex) order, the same order as
+// priority_queue<pair<int, int>> with greater<>, so shortest path trees match.
+
+enum QueueKind
+{
+	QUEUE_AUTO,		// Pick from the graph profile
+	QUEUE_BINARY,	// std::priority_queue with lazy deletion
+	QUEUE_DIAL,		// Dial bucket queue, small max weight
+	QUEUE_RADIX,	// Radix heap, any non-negative weight
+	QUEUE_DARY		// Indexed 4-ary heap with decrease-key
+};
+
+// Operation counters of one queue
+struct QueueStats
+{
+	long long pushes;
+	long long pops;
+	long long decreases;	// Decrease-key calls (indexed heap only)
+};
+
+// Edge statistics gathered once per LOAD
+struct GraphProfile
+{
+	int minWeight;
+	int maxWeight;
+	long long edges;	// Directed edge count
+	long long minCount;	// Edges weighing minWeight
+	long long maxCount;	// Edges weighing maxWeight
+};
+
+GraphProfile profileGraph(Graph *graph);
+
+// Keep profile in step with one edge change already applied to graph:
+// an edge of oldWeight removed and/or an edge of newWeight added
+void updateProfile(GraphProfile &profile, Graph *graph, bool removed, int oldWeight, bool added, int newWeight);
+
+// Queue kind for a graph, honoring DS_DIJKSTRA_QUEUE=binary|dial|radix|dary
+QueueKind chooseQueue(const GraphProfile &profile, int size);
+const char *queueName(QueueKind kind);
+
+// Original binary heap, lazy deletion
+class BinaryQueue
+{
+private:
+	vector<pair<int, int>> m_Heap;
+
+public:
+	QueueStats stats;
+	static const bool lazy = true;	// Pop may return outdated entries
+
+	BinaryQueue(int size, int maxWeight);
+	bool empty() { return m_Heap.empty(); }
+	void push(int key, int vertex);
+	int pop(int &key);
+};
+
+// Dial's algorithm: circular array of maxWeight + 1 buckets indexed by key
+class DialQueue
+{
+private:
+	vector<vector<int>> m_Bucket;	// Each bucket is a min-heap of vertices
+	int m_Width;
+	int m_Cur;						// Smallest key that may still be queued
+	long long m_Count;
+
+public:
+	QueueStats stats;
+	static const bool lazy = true;
+
+	DialQueue(int size, int maxWeight);
+	bool empty() { return m_Count == 0; }
+	void push(int key, int vertex);
+	int pop(int &key);
+};
+
+// Radix heap: bucket i holds keys whose highest bit differing from the last popped key is i - 1
+class RadixQueue
+{
+private:
+	vector<int> m_Same;						// Bucket 0 (key == m_Last), min-heap of vertices
+	vector<pair<int, int>> m_Bucket[33];	// (key, vertex)
+	unsigned m_Last;
+	long long m_Count;
+
+	static int bucketOf(unsigned key, unsigned last);
+
+public:
+	QueueStats stats;
+	static const bool lazy = true;
+
+	RadixQueue(int size, int maxWeight);
+	bool empty() { return m_Count == 0; }
+	void push(int key, int vertex);
+	int pop(int &key);
+};
+
+// Indexed 4-ary heap, push lowers the key of a queued vertex instead of duplicating it
+class DaryQueue
+{
+private:
+	vector<int> m_Heap;	// Vertices
+	vector<int> m_Pos;	// Heap slot of each vertex, -1 when absent
+	vector<int> m_Key;
+
+	bool less(int a, int b);
+	void siftUp(int slot);
+	void siftDown(int slot);
+
+public:
+	QueueStats stats;
+	static const bool lazy = false;
+
+	DaryQueue(int size, int maxWeight);
+	bool empty() { return m_Heap.empty(); }
+	void push(int key, int vertex);
+	int pop(int &key);
+};
+
+#endif
@@ -6,12 +6,14 @@ ListGraph::ListGraph(bool type, int size) : Graph(type, size)
 {
     // Create adjacency list
     m_List = new map<int, int>[size];
+    m_InList = new map<int, int>[size];
 }
 
 ListGraph::~ListGraph()
 {
     // Delete Graph
     delete[] m_List;
+    delete[] m_InList;
 }
 
 void ListGraph::getAdjacentEdges(int vertex, map<int, int> *m) // Definition of getAdjacentEdges(No Direction == Undirected)
@@ -25,12 +27,9 @@ void ListGraph::getAdjacentEdges(int vertex, map<int, int> *m) // Definition of
     }
 
     // Add incoming edges to treat the graph as undirected
-    for (int i = 0; i < m_Size; i++)
+    for (auto &cur_vertex : m_InList[vertex])
     {
-        if (m_List[i].find(vertex) != m_List[i].end())
-        {
-            (*m)[i] = m_List[i][vertex];
-        }
+        (*m)[cur_vertex.first] = cur_vertex.second;
     }
 }
 
@@ -46,9 +45,21 @@ void ListGraph::getAdjacentEdgesDirect(int vertex, map<int, int> *m) // Definiti
 void ListGraph::insertEdge(int from, int to, int weight) // Definition of insertEdge
 {
     m_List[from][to] = weight;
+    // Keep reverse index in sync
+    m_InList[to][from] = weight;
+}
+
+bool ListGraph::removeEdge(int from, int to) // Definition of removeEdge
+{
+    if (m_List[from].erase(to) == 0)
+    {
+        return false;
+    }
+    m_InList[to].erase(from);
+    return true;
 }
 
-bool ListGraph::printGraph(ofstream *fout) // Definition of print Graph
+bool ListGraph::printGraph(LogSink *fout) // Definition of print Graph
 {
     if (!fout || !fout->is_open())
     {
@@ -78,4 +89,75 @@ bool ListGraph::printGraph(ofstream *fout) // Definition of print Graph
     }
 
     return true;
-}
\ No newline at end of file
+}
+
+void ListGraph::forEachOutEdge(int vertex, EdgeVisitor &visitor)
+{
+    for (auto &edge : m_List[vertex])
+    {
+        if (!visitor.visit(edge.first, edge.second))
+            return;
+    }
+}
+
+void ListGraph::forEachInEdge(int vertex, EdgeVisitor &visitor)
+{
+    for (auto &edge : m_InList[vertex])
+    {
+        if (!visitor.visit(edge.first, edge.second))
+            return;
+    }
+}
+
+void ListGraph::mergeAdjacent(int vertex, bool inWins, EdgeVisitor &visitor)
+{
+    // Merge sorted out/in lists, inWins picks which weight a two-way pair reports
+    map<int, int>::iterator out = m_List[vertex].begin(), outEnd = m_List[vertex].end();
+    map<int, int>::iterator in = m_InList[vertex].begin(), inEnd = m_InList[vertex].end();
+
+    while (out != outEnd || in != inEnd)
+    {
+        bool keep;
+        if (in == inEnd || (out != outEnd && out->first < in->first))
+        {
+            keep = visitor.visit(out->first, out->second);
+            ++out;
+        }
+        else if (out == outEnd || in->first < out->first)
+        {
+            keep = visitor.visit(in->first, in->second);
+            ++in;
+        }
+        else
+        {
+            keep = visitor.visit(in->first, inWins ? in->second : out->second);
+            ++out;
+            ++in;
+        }
+
+        if (!keep)
+            return;
+    }
+}
+
+void ListGraph::forEachAdjacentEdge(int vertex, EdgeVisitor &visitor)
+{
+    // Incoming weight wins on a tie like getAdjacentEdges
+    mergeAdjacent(vertex, true, visitor);
+}
+
+void ListGraph::forEachReverseAdjacentEdge(int vertex, EdgeVisitor &visitor)
+{
+    // Neighbor u sees vertex with u's outgoing weight when it exists
+    mergeAdjacent(vertex, false, visitor);
+}
+
+int ListGraph::outDegree(int vertex)
+{
+    return (int)m_List[vertex].size();
+}
+
+int ListGraph::inDegree(int vertex)
+{
+    return (int)m_InList[vertex].size();
+}
@@ -7,8 +7,11 @@ class ListGraph : public Graph
 {
 private:
 	map<int, int> *m_List;
+	map<int, int> *m_InList; // Reverse index: m_InList[to][from] = weight
 	vector<int> *kw_graph;
 
+	void mergeAdjacent(int vertex, bool inWins, EdgeVisitor &visitor);
+
 public:
 	ListGraph(bool type, int size);
 	~ListGraph();
@@ -16,7 +19,14 @@ public:
 	void getAdjacentEdges(int vertex, map<int, int> *m);
 	void getAdjacentEdgesDirect(int vertex, map<int, int> *m);
 	void insertEdge(int from, int to, int weight);
-	bool printGraph(ofstream *fout);
+	bool removeEdge(int from, int to);
+	bool printGraph(LogSink *fout);
+	void forEachOutEdge(int vertex, EdgeVisitor &visitor);
+	void forEachInEdge(int vertex, EdgeVisitor &visitor);
+	void forEachAdjacentEdge(int vertex, EdgeVisitor &visitor);
+	void forEachReverseAdjacentEdge(int vertex, EdgeVisitor &visitor);
+	int outDegree(int vertex);
+	int inDegree(int vertex);
 };
 
 #endif
\ No newline at end of file
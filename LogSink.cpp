@@ -0,0 +1,258 @@
+#include "LogSink.h"
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+// Size of each of the two buffers
+static const size_t LOG_BUFFER = 1 << 20;
+
+LogSink::LogSink()
+{
+    m_Fd = -1;
+    m_Used = 0;
+    m_BackUsed = 0;
+    m_Pending = false;
+    m_Stop = false;
+    m_Memory = false;
+}
+
+LogSink::~LogSink()
+{
+    close();
+}
+
+bool LogSink::open(const char *path)
+{
+    return attach(::open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644));
+}
+
+bool LogSink::attach(int fd)
+{
+    close();
+
+    m_Fd = fd;
+    if (m_Fd < 0)
+    {
+        return false;
+    }
+
+    m_Front.resize(LOG_BUFFER);
+    m_Back.resize(LOG_BUFFER);
+    m_Used = 0;
+    m_Pending = false;
+    m_Stop = false;
+    m_Writer = thread(&LogSink::writerLoop, this);
+    return true;
+}
+
+void LogSink::openMemory()
+{
+    close();
+
+    m_Memory = true;
+    m_Used = 0;
+}
+
+bool LogSink::is_open() const
+{
+    return m_Fd >= 0 || m_Memory;
+}
+
+const char *LogSink::text() const
+{
+    return m_Front.data();
+}
+
+size_t LogSink::length() const
+{
+    return m_Used;
+}
+
+void LogSink::clear()
+{
+    m_Used = 0;
+}
+
+void LogSink::writerLoop()
+{
+    unique_lock<mutex> lock(m_Lock);
+    while (true)
+    {
+        m_Wake.wait(lock, [this]
+        {
+            return m_Pending || m_Stop;
+        });
+        if (!m_Pending)
+        {
+            return;
+        }
+
+        // The back buffer belongs to the writer until m_Pending is cleared
+        lock.unlock();
+        const char *data = m_Back.data();
+        size_t left = m_BackUsed;
+        while (left > 0)
+        {
+            ssize_t done = ::write(m_Fd, data, left);
+            if (done <= 0)
+            {
+                break;
+            }
+            data += done;
+            left -= (size_t)done;
+        }
+        lock.lock();
+
+        m_Pending = false;
+        m_Idle.notify_all();
+    }
+}
+
+void LogSink::handOff()
+{
+    unique_lock<mutex> lock(m_Lock);
+    m_Idle.wait(lock, [this]
+    {
+        return !m_Pending;
+    });
+
+    m_Front.swap(m_Back);
+    m_BackUsed = m_Used;
+    m_Used = 0;
+    m_Pending = true;
+    m_Wake.notify_one();
+}
+
+void LogSink::flush()
+{
+    if (m_Fd < 0)
+    {
+        return;
+    }
+    if (m_Used > 0)
+    {
+        handOff();
+    }
+
+    unique_lock<mutex> lock(m_Lock);
+    m_Idle.wait(lock, [this]
+    {
+        return !m_Pending;
+    });
+}
+
+void LogSink::close()
+{
+    m_Memory = false;
+    if (m_Fd < 0)
+    {
+        return;
+    }
+
+    flush();
+    {
+        lock_guard<mutex> lock(m_Lock);
+        m_Stop = true;
+    }
+    m_Wake.notify_one();
+    m_Writer.join();
+
+    ::close(m_Fd);
+    m_Fd = -1;
+}
+
+void LogSink::write(const char *data, size_t length)
+{
+    if (m_Memory)
+    {
+        // Grow geometrically, nothing is handed off
+        if (m_Used + length > m_Front.size())
+        {
+            m_Front.resize(max(m_Used + length, max((size_t)4096, m_Front.size() * 2)));
+        }
+        memcpy(m_Front.data() + m_Used, data, length);
+        m_Used += length;
+        return;
+    }
+    if (m_Fd < 0)
+    {
+        return;
+    }
+
+    // Copy in buffer-sized pieces, handing off each full buffer
+    while (length > 0)
+    {
+        if (m_Used == LOG_BUFFER)
+        {
+            handOff();
+        }
+        size_t piece = min(length, LOG_BUFFER - m_Used);
+        memcpy(m_Front.data() + m_Used, data, piece);
+        m_Used += piece;
+        data += piece;
+        length -= piece;
+    }
+}
+
+LogSink &LogSink::operator<<(const char *text)
+{
+    write(text, strlen(text));
+    return *this;
+}
+
+LogSink &LogSink::operator<<(const string &text)
+{
+    write(text.data(), text.size());
+    return *this;
+}
+
+LogSink &LogSink::operator<<(char c)
+{
+    if (m_Fd >= 0 && m_Used < LOG_BUFFER)
+    {
+        m_Front[m_Used++] = c;
+        return *this;
+    }
+    write(&c, 1);
+    return *this;
+}
+
+LogSink &LogSink::operator<<(int value)
+{
+    return *this << (long long)value;
+}
+
+LogSink &LogSink::operator<<(long long value)
+{
+    // Digits are produced backwards into a small scratch buffer
+    char text[24];
+    char *end = text + sizeof(text);
+    char *p = end;
+
+    unsigned long long magnitude = value < 0 ? 0ULL - (unsigned long long)value : (unsigned long long)value;
+    do
+    {
+        *--p = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude);
+    if (value < 0)
+    {
+        *--p = '-';
+    }
+
+    write(p, end - p);
+    return *this;
+}
+
+LogSink &LogSink::operator<<(ostream &(*manip)(ostream &))
+{
+    if (manip == static_cast<ostream &(*)(ostream &)>(endl))
+    {
+        *this << '\n';
+    }
+    else if (manip == static_cast<ostream &(*)(ostream &)>(std::flush))
+    {
+        flush();
+    }
+    return *this;
+}
@@ -0,0 +1,66 @@
+#ifndef _LOGSINK_H_
+#define _LOGSINK_H_
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+using namespace std;
+
+// Buffered log file with a background writer thread.
+// Text is appended to the front buffer. When it fills up (every LOG_BUFFER bytes)
+// it is swapped with the back buffer, which the writer thread drains while the
+// caller keeps filling. flush() hands off whatever is buffered and waits until
+// it reached the file. endl only appends '\n', it does not flush.
+// openMemory() instead keeps everything in one growing buffer, for output that
+// is rendered on a worker thread and written to the real log later.
+class LogSink
+{
+private:
+	int m_Fd;					// -1 when not open
+	vector<char> m_Front;		// Filled by the caller
+	vector<char> m_Back;		// Drained by the writer
+	size_t m_Used;				// Bytes in m_Front
+	size_t m_BackUsed;			// Bytes in m_Back to write
+
+	thread m_Writer;
+	mutex m_Lock;
+	condition_variable m_Wake;	// Writer: back buffer ready or stop
+	condition_variable m_Idle;	// Caller: back buffer drained
+	bool m_Pending;				// m_Back holds data not written yet
+	bool m_Stop;
+	bool m_Memory;				// Capturing into m_Front, no file and no writer
+
+	void writerLoop();
+	void handOff();				// Swap buffers once the writer is idle
+
+public:
+	LogSink();
+	~LogSink();
+
+	bool open(const char *path);	// Truncates the file
+	bool attach(int fd);			// Writes to an open descriptor (stdout, a socket), closed by close()
+	void openMemory();
+	bool is_open() const;
+	void flush();
+	void close();
+
+	void write(const char *data, size_t length);
+
+	// Captured text of a memory sink, clear() keeps the storage for reuse
+	const char *text() const;
+	size_t length() const;
+	void clear();
+
+	LogSink &operator<<(const char *text);
+	LogSink &operator<<(const string &text);
+	LogSink &operator<<(char c);
+	LogSink &operator<<(int value);
+	LogSink &operator<<(long long value);
+	LogSink &operator<<(ostream &(*manip)(ostream &));	// endl and flush
+};
+
+#endif
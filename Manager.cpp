@@ -1,16 +1,158 @@
 #include "Manager.h"
 #include "GraphMethod.h"
+#include "GraphLoader.h"
+#include "GraphSnapshot.h"
 #include <iostream>
 #include <fstream>
-#include <sstream>
 #include <vector>
 #include <string>
+#include <cstdlib>
+#include <sstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "ThreadPool.h"
+
+// Queries of a batch in flight per thread, bounds the rendered output held in memory
+static const int BATCH_WAVE = 4;
+
+// Parsed commands the parser stage may run ahead of execution
+static const size_t PIPE_DEPTH = 1024;
+
+// Whitespace separated integers up to the end of text, false on anything else
+static bool readInts(const string &text, vector<int> &values)
+{
+	istringstream in(text);
+	int value;
+	while (in >> value)
+		values.push_back(value);
+	return in.eof();
+}
+
+// Error code of each command, 0 for EXIT and unknown words
+static int commandCode(const string &name)
+{
+	static const struct
+	{
+		const char *name;
+		int code;
+	} codes[] = {
+		{"LOAD", 100}, {"PRINT", 200}, {"BFS", 300}, {"DFS", 400}, {"KRUSKAL", 500},
+		{"DIJKSTRA", 600}, {"BELLMANFORD", 700}, {"FLOYD", 800}, {"CENTRALITY", 900},
+		{"PATH", 1000}, {"REACH", 1100}, {"SAVE", 1200}, {"STATS", 1300},
+		{"INSERT_EDGE", 1400}, {"DELETE_EDGE", 1500}, {"UPDATE_EDGE", 1600},
+		{"DIJKSTRA_BATCH", 1700}, {"BELLMANFORD_BATCH", 1800},
+	};
+	for (auto &c : codes)
+	{
+		if (name == c.name)
+			return c.code;
+	}
+	return 0;
+}
+
+bool Manager::isReadOnly(const Command &cmd)
+{
+	// Commands that change the graph, files or recorder state keep their place in line
+	static const char *ordered[] = {"LOAD", "SAVE", "STATS", "INSERT_EDGE", "DELETE_EDGE", "UPDATE_EDGE", "EXIT"};
+	if (cmd.error)
+		return true;
+	for (const char *name : ordered)
+	{
+		if (cmd.name == name)
+			return false;
+	}
+	return true;
+}
+
+bool Manager::isParallel(const Command &cmd)
+{
+	// Commands that spread over defaultPool() themselves; inside a group they would run
+	// on one thread, as the pool runs nested jobs inline
+	static const char *spread[] = {"BFS", "REACH", "FLOYD", "CENTRALITY", "KRUSKAL", "DIJKSTRA_BATCH", "BELLMANFORD_BATCH"};
+	if (cmd.error)
+		return false;
+	for (const char *name : spread)
+	{
+		if (cmd.name == name)
+			return true;
+	}
+	return false;
+}
+
+// Bounded queue from the parser thread to the dispatcher
+class CommandPipe
+{
+private:
+	deque<Command> m_Items;
+	mutex m_Lock;
+	condition_variable m_Changed;
+	bool m_Done;	// Parser reached the end of the stream
+	bool m_Closed;	// Dispatcher stopped reading (EXIT)
+
+public:
+	CommandPipe() : m_Done(false), m_Closed(false) {}
+
+	// false once the dispatcher is gone
+	bool push(Command &cmd)
+	{
+		unique_lock<mutex> lock(m_Lock);
+		m_Changed.wait(lock, [this]
+		{
+			return m_Items.size() < PIPE_DEPTH || m_Closed;
+		});
+		if (m_Closed)
+			return false;
+		m_Items.push_back(cmd);
+		m_Changed.notify_all();
+		return true;
+	}
+
+	// false at the end of the stream
+	bool pop(Command &cmd)
+	{
+		unique_lock<mutex> lock(m_Lock);
+		m_Changed.wait(lock, [this]
+		{
+			return !m_Items.empty() || m_Done;
+		});
+		if (m_Items.empty())
+			return false;
+		cmd = m_Items.front();
+		m_Items.pop_front();
+		m_Changed.notify_all();
+		return true;
+	}
 
-Manager::Manager()
+	void finish()
+	{
+		lock_guard<mutex> lock(m_Lock);
+		m_Done = true;
+		m_Changed.notify_all();
+	}
+
+	void close()
+	{
+		lock_guard<mutex> lock(m_Lock);
+		m_Closed = true;
+		m_Changed.notify_all();
+	}
+};
+
+Manager::Manager(const char *log_txt)
 {
 	graph = nullptr;
-	fout.open("log.txt", ios::trunc);
+	if (log_txt)
+		fout.open(log_txt);
 	load = 0; // Anything is not loaded
+
+	// Select graph backend
+	const char *backend = getenv("DS_GRAPH_BACKEND");
+	useCsr = backend != nullptr && string(backend) == "csr";
+
+	profile.minWeight = profile.maxWeight = 0;
+	profile.edges = 0;
+	queueStats.pushes = queueStats.pops = queueStats.decreases = 0;
 }
 
 Manager::~Manager()
@@ -32,252 +174,254 @@ void Manager::run(const char *command_txt)
 		return; // Return
 	}
 
-	string cmd;
+	// DS_PIPELINE=1 runs read-only commands side by side, the log stays the same
+	const char *pipeline = getenv("DS_PIPELINE");
+	if (pipeline && string(pipeline) == "1")
+	{
+		runPipelined(fin);
+		fin.close();
+		return;
+	}
 
-	while (fin >> cmd)
+	Command cmd;
+	while (readCommand(fin, cmd))
 	{
-		string rest;	   // For checking extra arguments
-		bool valid = true; // For checking argument validity
+		// Close the previous command's measurement and start this one
+		stats.end();
+		stats.begin(cmd.name);
 
-		if (cmd == "LOAD")
-		{
-			string filename;
-			if (!(fin >> filename))
-			{
-				printErrorCode(100);
-				fin.clear();
-				getline(fin, rest);
-				continue;
-			}
-
-			getline(fin, rest);
-			for (char c : rest)
-			{
-				if (!isspace(c))
-				{
-					printErrorCode(100);
-					valid = false;
-					break;
-				}
-			}
-			if (!valid)
-				continue;
-
-			LOAD(filename.c_str());
-		}
-		else if (cmd == "PRINT")
-		{
-			getline(fin, rest);
-			for (char c : rest)
-			{
-				if (!isspace(c))
-				{
-					printErrorCode(200);
-					valid = false;
-					break;
-				}
-			}
-			if (!valid)
-				continue;
-
-			PRINT();
-		}
-		else if (cmd == "BFS")
-		{
-			char option;
-			int vertex;
-
-			if (!(fin >> option >> vertex))
-			{
-				printErrorCode(300);
-				fin.clear();
-				getline(fin, rest);
-				continue;
-			}
-
-			getline(fin, rest);
-			for (char c : rest)
-			{
-				if (!isspace(c))
-				{
-					printErrorCode(300);
-					valid = false;
-					break;
-				}
-			}
-			if (!valid)
-				continue;
-
-			mBFS(option, vertex);
-		}
-		else if (cmd == "DFS")
-		{
-			char option;
-			int vertex;
-
-			if (!(fin >> option >> vertex))
-			{
-				printErrorCode(400);
-				fin.clear();
-				getline(fin, rest);
-				continue;
-			}
-
-			getline(fin, rest);
-			for (char c : rest)
-			{
-				if (!isspace(c))
-				{
-					printErrorCode(400);
-					valid = false;
-					break;
-				}
-			}
-			if (!valid)
-				continue;
-
-			mDFS(option, vertex);
-		}
-		else if (cmd == "DIJKSTRA")
-		{
-			char option;
-			int vertex;
-
-			if (!(fin >> option >> vertex))
-			{
-				printErrorCode(600);
-				fin.clear();
-				getline(fin, rest);
-				continue;
-			}
-
-			getline(fin, rest);
-			for (char c : rest)
-			{
-				if (!isspace(c))
-				{
-					printErrorCode(600);
-					valid = false;
-					break;
-				}
-			}
-			if (!valid)
-				continue;
-
-			mDIJKSTRA(option, vertex);
-		}
-		else if (cmd == "KRUSKAL")
+		execute(cmd, fout);
+		if (cmd.name == "EXIT")
+			break;
+	}
+
+	stats.end();
+	fin.close();
+	return;
+}
+
+bool Manager::readCommand(istream &fin, Command &cmd)
+{
+	if (!(fin >> cmd.name))
+		return false;
+
+	cmd.error = 0;
+	cmd.option = 0;
+	cmd.text.clear();
+	cmd.args.clear();
+
+	const string &name = cmd.name;
+	int code = commandCode(name);
+	string rest; // For checking extra arguments
+	bool batch = name == "DIJKSTRA_BATCH" || name == "BELLMANFORD_BATCH";
+
+	// Arguments by command shape
+	bool valid = true;
+	if (name == "LOAD" || name == "SAVE" || name == "STATS")
+	{
+		valid = (bool)(fin >> cmd.text);
+	}
+	else if (name == "BFS" || name == "DFS" || name == "REACH" || name == "DIJKSTRA")
+	{
+		cmd.args.resize(1);
+		valid = (bool)(fin >> cmd.option >> cmd.args[0]);
+	}
+	else if (name == "BELLMANFORD" || name == "PATH")
+	{
+		cmd.args.resize(2);
+		valid = (bool)(fin >> cmd.option >> cmd.args[0] >> cmd.args[1]);
+	}
+	else if (name == "FLOYD" || batch)
+	{
+		valid = (bool)(fin >> cmd.option);
+	}
+	else if (name == "INSERT_EDGE" || name == "UPDATE_EDGE")
+	{
+		cmd.args.resize(3);
+		valid = (bool)(fin >> cmd.args[0] >> cmd.args[1] >> cmd.args[2]);
+	}
+	else if (name == "DELETE_EDGE")
+	{
+		cmd.args.resize(2);
+		valid = (bool)(fin >> cmd.args[0] >> cmd.args[1]);
+	}
+
+	// Missing or malformed argument, the rest of the line is dropped
+	if (!valid)
+	{
+		cmd.error = code;
+		fin.clear();
+		getline(fin, rest);
+		return true;
+	}
+
+	getline(fin, rest);
+	if (batch)
+	{
+		// The rest of the line is the query list
+		if (!readInts(rest, cmd.args) || cmd.args.empty() || (name == "BELLMANFORD_BATCH" && cmd.args.size() % 2))
+			cmd.error = code;
+		return true;
+	}
+
+	// EXIT and unknown words ignore the rest of the line
+	if (code == 0)
+		return true;
+	for (char c : rest)
+	{
+		if (!isspace(c))
 		{
-			getline(fin, rest);
-			for (char c : rest)
-			{
-				if (!isspace(c))
-				{
-					printErrorCode(500);
-					valid = false;
-					break;
-				}
-			}
-			if (!valid)
-				continue;
-
-			mKRUSKAL();
+			cmd.error = code;
+			break;
 		}
-		else if (cmd == "BELLMANFORD")
+	}
+	return true;
+}
+
+void Manager::execute(const Command &cmd, LogSink &out)
+{
+	if (cmd.error)
+	{
+		printErrorCode(out, cmd.error);
+		return;
+	}
+
+	const string &name = cmd.name;
+	const vector<int> &a = cmd.args;
+	if (name == "LOAD")
+		LOAD(out, cmd.text.c_str());
+	else if (name == "SAVE")
+		SAVE(out, cmd.text.c_str());
+	else if (name == "PRINT")
+		PRINT(out);
+	else if (name == "BFS")
+		mBFS(out, cmd.option, a[0]);
+	else if (name == "DFS")
+		mDFS(out, cmd.option, a[0]);
+	else if (name == "REACH")
+		mREACH(out, cmd.option, a[0]);
+	else if (name == "DIJKSTRA")
+		mDIJKSTRA(out, cmd.option, a[0]);
+	else if (name == "DIJKSTRA_BATCH")
+		mDIJKSTRABATCH(out, cmd.option, a);
+	else if (name == "KRUSKAL")
+		mKRUSKAL(out);
+	else if (name == "BELLMANFORD")
+		mBELLMANFORD(out, cmd.option, a[0], a[1]);
+	else if (name == "BELLMANFORD_BATCH")
+		mBELLMANFORDBATCH(out, cmd.option, a);
+	else if (name == "PATH")
+		mPATH(out, cmd.option, a[0], a[1]);
+	else if (name == "FLOYD")
+		mFLOYD(out, cmd.option);
+	else if (name == "CENTRALITY")
+		mCentrality(out);
+	else if (name == "STATS")
+		mSTATS(out, cmd.text);
+	else if (name == "INSERT_EDGE")
+		mINSERTEDGE(out, a[0], a[1], a[2]);
+	else if (name == "DELETE_EDGE")
+		mDELETEEDGE(out, a[0], a[1]);
+	else if (name == "UPDATE_EDGE")
+		mUPDATEEDGE(out, a[0], a[1], a[2]);
+	else if (name == "EXIT")
+		EXIT(out);
+}
+
+void Manager::executeMeasured(const Command &cmd, LogSink &out)
+{
+	stats.end();
+	stats.begin(cmd.name);
+	execute(cmd, out);
+	stats.end();
+}
+
+bool Manager::measuring() const
+{
+	return stats.enabled();
+}
+
+void Manager::runPipelined(istream &fin)
+{
+	// Stage 1: the parser thread tokenizes ahead of execution
+	CommandPipe pipe;
+	thread parser([&]
+	{
+		Command cmd;
+		while (readCommand(fin, cmd) && pipe.push(cmd))
 		{
-			char option;
-			int s, e;
-
-			if (!(fin >> option >> s >> e))
-			{
-				printErrorCode(700);
-				fin.clear();
-				getline(fin, rest);
-				continue;
-			}
-
-			getline(fin, rest);
-			for (char c : rest)
-			{
-				if (!isspace(c))
-				{
-					printErrorCode(700);
-					valid = false;
-					break;
-				}
-			}
-			if (!valid)
-				continue;
-
-			mBELLMANFORD(option, s, e);
 		}
-		else if (cmd == "FLOYD")
+		pipe.finish();
+	});
+
+	// Stage 2: consecutive read-only commands form a group, anything else runs alone
+	// with the whole pool
+	int wave = defaultPool().size() * BATCH_WAVE;
+	vector<Command> group;
+	Command cmd;
+	bool more = pipe.pop(cmd);
+	while (more)
+	{
+		group.clear();
+		while (more && isReadOnly(cmd) && !isParallel(cmd) && (int)group.size() < wave)
 		{
-			char option;
-
-			if (!(fin >> option))
-			{
-				printErrorCode(800);
-				fin.clear();
-				getline(fin, rest);
-				continue;
-			}
-
-			getline(fin, rest);
-			for (char c : rest)
-			{
-				if (!isspace(c))
-				{
-					printErrorCode(800);
-					valid = false;
-					break;
-				}
-			}
-			if (!valid)
-				continue;
-
-			mFLOYD(option);
+			group.push_back(cmd);
+			more = pipe.pop(cmd);
 		}
-		else if (cmd == "CENTRALITY")
+		if (!group.empty())
 		{
-			getline(fin, rest);
-			for (char c : rest)
-			{
-				if (!isspace(c))
-				{
-					printErrorCode(900);
-					valid = false;
-					break;
-				}
-			}
-			if (!valid)
-				continue;
-
-			mCentrality();
+			runGroup(group);
+			continue;
 		}
-		else if (cmd == "EXIT")
-		{
-			getline(fin, rest);
-			EXIT();
+
+		stats.end();
+		stats.begin(cmd.name);
+		execute(cmd, fout);
+		if (cmd.name == "EXIT")
 			break;
-		}
-		else
+		more = pipe.pop(cmd);
+	}
+
+	pipe.close();
+	parser.join();
+	stats.end();
+}
+
+void Manager::runGroup(const vector<Command> &group)
+{
+	// Measurements need the commands one at a time, a lone command skips the buffer
+	if (stats.enabled() || group.size() == 1)
+	{
+		for (auto &cmd : group)
 		{
-			getline(fin, rest);
-			continue;
+			stats.end();
+			stats.begin(cmd.name);
+			execute(cmd, fout);
 		}
+		return;
 	}
 
-	fin.close();
-	return;
+	// Keep the recorder's command numbering
+	for (auto &cmd : group)
+	{
+		stats.end();
+		stats.begin(cmd.name);
+	}
+
+	// Stage 3: every command renders into its own buffer, committed in command order
+	runBatch(fout, (int)group.size(), [&](int i, int, LogSink &item)
+	{
+		execute(group[i], item);
+	});
 }
 
-bool Manager::LOAD(const char *filename)
+bool Manager::LOAD(LogSink &out, const char *filename)
 {
-	ifstream fin(filename);
-	if (!fin.is_open())
+	MappedFile *file = new MappedFile;
+	if (!file->open(filename))
 	{
-		printErrorCode(100);
+		delete file;
+		printErrorCode(out, 100);
 		return false;
 	}
 
@@ -287,266 +431,463 @@ bool Manager::LOAD(const char *filename)
 		graph = nullptr;
 		load = 0;
 	}
+	// Results of the previous graph are no longer valid
+	cache.invalidate();
+	sssp.reset();
+	mst.reset();
 
-	char typeChar;
-	int size;
-
-	fin >> typeChar; // L or M
-	fin >> size;	 // graph size
-
-	if (!fin || (typeChar != 'L' && typeChar != 'M') || size <= 0)
+	if (isSnapshot(file->data(), file->size()))
 	{
-		printErrorCode(100);
-		return false;
+		// Binary snapshot is used in place, the graph keeps the mapping
+		graph = openSnapshot(file);
 	}
-
-	// Create graph
-	if (typeChar == 'L')
+	else
 	{
-		graph = new ListGraph(true, size);
+		// Parse L or M text, straight into CSR arrays when useCsr
+		graph = parseGraphText(file->data(), file->size(), useCsr);
+		delete file;
 	}
-	else
+	if (graph == nullptr)
 	{
-		graph = new MatrixGraph(false, size);
+		printErrorCode(out, 100);
+		return false;
 	}
 
-	// L type
-	if (typeChar == 'L')
-	{
-		string line;
-		getline(fin, line);
+	// Weight range decides the Dijkstra queue
+	profile = profileGraph(graph);
 
-		int next_start = -1;
+	load = 1;
 
-		for (int cur = 0; cur < size; cur++)
-		{
-			string startLine;
-
-			// Read start
-			if (next_start == -1)
-			{
-				if (!getline(fin, startLine))
-				{
-					printErrorCode(100);
-					return false;
-				}
-				next_start = stoi(startLine);
-			}
-
-			int start = next_start;
-			next_start = -1;
-
-			// Read edge
-			while (true)
-			{
-				streampos pos = fin.tellg();
-				if (!getline(fin, line))
-					break;
-
-				if (line.size() == 0)
-					continue;
-
-				stringstream ss(line);
-				vector<int> nums;
-				int x;
-				while (ss >> x)
-					nums.push_back(x);
-
-				if (nums.size() == 1)
-				{
-					next_start = nums[0];
-
-					break;
-				}
-				else if (nums.size() == 2)
-				{
-					int to = nums[0];
-					int weight = nums[1];
-					graph->insertEdge(start, to, weight);
-				}
-				else
-				{
-					printErrorCode(100);
-					return false;
-				}
-			}
-		}
-	}
-	else
+	out << "========LOAD========" << endl;
+	out << "Success" << endl;
+	out << "====================" << endl;
+	out << endl;
+	return true;
+}
+
+bool Manager::SAVE(LogSink &out, const char *filename)
+{
+	if (!load || graph == nullptr)
 	{
-		// M type
-		for (int i = 0; i < size; i++)
-		{
-			for (int j = 0; j < size; j++)
-			{
-				int weight;
-				if (!(fin >> weight))
-				{
-					printErrorCode(100);
-					return false;
-				}
-
-				if (weight != 0)
-				{
-					graph->insertEdge(i, j, weight);
-				}
-			}
-		}
+		printErrorCode(out, 1200);
+		return false;
 	}
 
-	load = 1;
+	// Binary snapshot that LOAD maps back without parsing
+	if (!saveSnapshot(graph, filename))
+	{
+		printErrorCode(out, 1200);
+		return false;
+	}
 
-	fout << "========LOAD========" << endl;
-	fout << "Success" << endl;
-	fout << "====================" << endl;
-	fout << endl;
+	out << "========SAVE========" << endl;
+	out << "Success" << endl;
+	out << "====================" << endl;
+	out << endl;
 	return true;
 }
 
-bool Manager::PRINT()
+bool Manager::PRINT(LogSink &out)
 {
 	if (!load || graph == nullptr)
 	{
-		printErrorCode(200);
+		printErrorCode(out, 200);
 		return false;
 	}
 
-	fout << "========PRINT========" << endl;
+	out << "========PRINT========" << endl;
 
 	// Print graph
-	graph->printGraph(&fout);
+	graph->printGraph(&out);
 
-	fout << "====================" << endl;
-	fout << endl;
+	out << "====================" << endl;
+	out << endl;
 
 	return true;
 }
 
-bool Manager::mBFS(char option, int vertex)
+bool Manager::mBFS(LogSink &out, char option, int vertex)
 {
 	if (!load || graph == nullptr)
 	{
-		printErrorCode(300);
+		printErrorCode(out, 300);
 		return false;
 	}
 
 	// Print BFS
-	return BFS(graph, option, vertex, &fout);
+	return BFS(graph, option, vertex, &out);
 }
 
-bool Manager::mDFS(char option, int vertex)
+bool Manager::mDFS(LogSink &out, char option, int vertex)
 {
 	if (!load || graph == nullptr)
 	{
-		printErrorCode(400);
+		printErrorCode(out, 400);
 		return false;
 	}
 
 	// Print DFS
-	return DFS(graph, option, vertex, &fout);
+	return DFS(graph, option, vertex, &out);
+}
+
+bool Manager::mREACH(LogSink &out, char option, int vertex)
+{
+	if (!load || graph == nullptr)
+	{
+		printErrorCode(out, 1100);
+		return false;
+	}
+
+	// If vertex is out of range, print error
+	if (!Reach(graph, option, vertex, &out))
+	{
+		printErrorCode(out, 1100);
+		return false;
+	}
+
+	return true;
 }
 
-bool Manager::mDIJKSTRA(char option, int vertex)
+bool Manager::mDIJKSTRA(LogSink &out, char option, int vertex)
 {
 	if (!load || graph == nullptr)
 	{
-		printErrorCode(600);
+		printErrorCode(out, 600);
 		return false;
 	}
 
+	// The tree kept across edge changes answers a repeated source without a search
+	{
+		lock_guard<mutex> guard(treeLock);
+		if (sssp.matches(option, vertex))
+		{
+			printDijkstra(&out, option, vertex, sssp.dist(), sssp.prev());
+			return true;
+		}
+	}
+
 	// if Dijkstra fails, print error
-	if (!Dijkstra(graph, option, vertex, &fout))
+	QueueStats stats = {0, 0, 0};
+	vector<int> dist, prev;
+	if (!dijkstraTree(graph, option, vertex, dist, prev, &profile, &stats))
 	{
-		printErrorCode(600);
+		printErrorCode(out, 600);
 		return false;
 	}
+	printDijkstra(&out, option, vertex, dist, prev);
+
+	// Commands running side by side share the tree and the counters
+	lock_guard<mutex> guard(treeLock);
+	sssp.assign(option, vertex, dist, prev);
+	queueStats.pushes += stats.pushes;
+	queueStats.pops += stats.pops;
+	queueStats.decreases += stats.decreases;
+
+	// Queue counters on stderr for comparing queue kinds
+	if (getenv("DS_QUEUE_STATS"))
+	{
+		cerr << "DIJKSTRA queue=" << queueName(chooseQueue(profile, graph->getSize()))
+			 << " pushes=" << stats.pushes << " pops=" << stats.pops
+			 << " decreases=" << stats.decreases << endl;
+	}
 
 	return true;
 }
 
-bool Manager::mKRUSKAL()
+bool Manager::mDIJKSTRABATCH(LogSink &out, char option, const vector<int> &sources)
 {
 	if (!load || graph == nullptr)
 	{
-		printErrorCode(500);
+		printErrorCode(out, 1700);
 		return false;
 	}
+
+	// Each query prints what DIJKSTRA would, errors included
+	vector<QueryWorkspace> ws(defaultPool().size());
+	for (auto &w : ws)
+		w.stats.pushes = w.stats.pops = w.stats.decreases = 0;
+
+	runBatch(out, (int)sources.size(), [&](int i, int worker, LogSink &item)
+	{
+		QueueStats one = {0, 0, 0};
+		if (!Dijkstra(graph, option, sources[i], &item, &profile, &one, &ws[worker]))
+		{
+			writeErrorCode(item, 600);
+			return;
+		}
+		ws[worker].stats.pushes += one.pushes;
+		ws[worker].stats.pops += one.pops;
+		ws[worker].stats.decreases += one.decreases;
+	});
+
+	QueueStats stats = {0, 0, 0};
+	for (auto &w : ws)
+	{
+		stats.pushes += w.stats.pushes;
+		stats.pops += w.stats.pops;
+		stats.decreases += w.stats.decreases;
+	}
+	lock_guard<mutex> guard(treeLock);
+	queueStats.pushes += stats.pushes;
+	queueStats.pops += stats.pops;
+	queueStats.decreases += stats.decreases;
+
+	if (getenv("DS_QUEUE_STATS"))
+	{
+		cerr << "DIJKSTRA_BATCH queries=" << sources.size()
+			 << " queue=" << queueName(chooseQueue(profile, graph->getSize()))
+			 << " pushes=" << stats.pushes << " pops=" << stats.pops
+			 << " decreases=" << stats.decreases << endl;
+	}
+
+	return true;
+}
+
+bool Manager::mKRUSKAL(LogSink &out)
+{
+	if (!load || graph == nullptr)
+	{
+		printErrorCode(out, 500);
+		return false;
+	}
+
+	// The maintained forest is shared with commands running side by side
+	lock_guard<mutex> guard(treeLock);
 	// if Kruskal fails, print error
-	else if (!Kruskal(graph, &fout))
+	if (!Kruskal(graph, &out, &profile, &mst))
 	{
-		printErrorCode(500);
+		printErrorCode(out, 500);
 		return false;
 	}
 	return true;
 }
 
-bool Manager::mBELLMANFORD(char option, int s_vertex, int e_vertex)
+bool Manager::mBELLMANFORD(LogSink &out, char option, int s_vertex, int e_vertex)
 {
 	if (!load || graph == nullptr)
 	{
-		printErrorCode(700);
+		printErrorCode(out, 700);
 		return false;
 	}
 
 	// If bellmanford fails, print error
-	if (!Bellmanford(graph, option, s_vertex, e_vertex, &fout))
+	if (!Bellmanford(graph, option, s_vertex, e_vertex, &out, nullptr, &cache))
+	{
+		printErrorCode(out, 700);
+		return false;
+	}
+
+	return true;
+}
+
+bool Manager::mBELLMANFORDBATCH(LogSink &out, char option, const vector<int> &pairs)
+{
+	if (!load || graph == nullptr)
+	{
+		printErrorCode(out, 1800);
+		return false;
+	}
+
+	// Each (s, e) prints what BELLMANFORD would, errors included
+	vector<QueryWorkspace> ws(defaultPool().size());
+	runBatch(out, (int)pairs.size() / 2, [&](int i, int worker, LogSink &item)
+	{
+		if (!Bellmanford(graph, option, pairs[2 * i], pairs[2 * i + 1], &item, &ws[worker], &cache))
+			writeErrorCode(item, 700);
+	});
+
+	return true;
+}
+
+bool Manager::mPATH(LogSink &out, char option, int s_vertex, int e_vertex)
+{
+	if (!load || graph == nullptr)
 	{
-		printErrorCode(700);
+		printErrorCode(out, 1000);
+		return false;
+	}
+
+	// If path query fails, print error
+	if (!PathQuery(graph, option, s_vertex, e_vertex, &out, &profile, &cache))
+	{
+		printErrorCode(out, 1000);
 		return false;
 	}
 
 	return true;
 }
 
-bool Manager::mFLOYD(char option)
+bool Manager::mFLOYD(LogSink &out, char option)
 {
 	if (!load || graph == nullptr)
 	{
-		printErrorCode(800);
+		printErrorCode(out, 800);
 		return false;
 	}
 
 	// If Floyd fails, print error
-	if (!FLOYD(graph, option, &fout))
+	if (!FLOYD(graph, option, &out, &cache))
 	{
-		printErrorCode(800);
+		printErrorCode(out, 800);
 		return false;
 	}
 
 	return true;
 }
 
-bool Manager::mCentrality()
+bool Manager::mCentrality(LogSink &out)
 {
 	if (!load || graph == nullptr)
 	{
-		printErrorCode(900);
+		printErrorCode(out, 900);
 		return false;
 	}
 
 	// if Centrality fails, print error
-	if (!Centrality(graph, &fout))
+	if (!Centrality(graph, &out, &cache))
 	{
-		printErrorCode(900);
+		printErrorCode(out, 900);
 		return false;
 	}
 	return true;
 }
 
-bool Manager::EXIT()
+bool Manager::mSTATS(LogSink &out, const string &mode)
+{
+	// Only the stats file changes, log.txt gets nothing on success
+	if (mode == "ON" && stats.enable())
+	{
+		return true;
+	}
+	if (mode == "OFF")
+	{
+		stats.disable();
+		return true;
+	}
+
+	printErrorCode(out, 1300);
+	return false;
+}
+
+// Shared part of INSERT_EDGE (1400), DELETE_EDGE (1500) and UPDATE_EDGE (1600)
+bool Manager::changeEdge(LogSink &out, int code, int from, int to, bool remove, int weight)
 {
-	fout << "========EXIT========" << endl;
-	fout << "Success" << endl;
-	fout << "====================" << endl;
-	fout << endl;
+	if (!load || graph == nullptr)
+	{
+		printErrorCode(out, code);
+		return false;
+	}
 
+	int size = graph->getSize();
+	if (from < 0 || from >= size || to < 0 || to >= size)
+	{
+		printErrorCode(out, code);
+		return false;
+	}
+
+	// Only INSERT_EDGE creates an edge, the other two need an existing one
+	int old = 0;
+	bool existed = graph->findEdge(from, to, old);
+	if (existed != (code != 1400))
+	{
+		printErrorCode(out, code);
+		return false;
+	}
+
+	// A matrix file has no way to write a 0-weight edge
+	if (!remove && weight == 0 && !graph->getType())
+	{
+		printErrorCode(out, code);
+		return false;
+	}
+
+	sssp.beforeChange(graph, from, to);
+	mst.beforeChange(graph, from, to);
+	if (remove)
+		graph->removeEdge(from, to);
+	else
+		graph->insertEdge(from, to, weight);
+
+	// Everything derived from the graph follows the change
+	cache.invalidate();
+	updateProfile(profile, graph, existed, old, !remove, weight);
+	sssp.afterChange(graph, profile.edges == 0 || profile.minWeight > 0);
+	mst.afterChange(graph);
+
+	out << "========" << (code == 1400 ? "INSERT_EDGE" : code == 1500 ? "DELETE_EDGE" : "UPDATE_EDGE") << "========" << endl;
+	out << "Success" << endl;
+	out << "====================" << endl;
+	out << endl;
 	return true;
 }
 
-void Manager::printErrorCode(int n)
+bool Manager::mINSERTEDGE(LogSink &out, int from, int to, int weight)
+{
+	return changeEdge(out, 1400, from, to, false, weight);
+}
+
+bool Manager::mDELETEEDGE(LogSink &out, int from, int to)
+{
+	return changeEdge(out, 1500, from, to, true, 0);
+}
+
+bool Manager::mUPDATEEDGE(LogSink &out, int from, int to, int weight)
+{
+	return changeEdge(out, 1600, from, to, false, weight);
+}
+
+bool Manager::EXIT(LogSink &out)
+{
+	out << "========EXIT========" << endl;
+	out << "Success" << endl;
+	out << "====================" << endl;
+	out << endl;
+	out.flush();
+
+	return true;
+}
+
+void Manager::runBatch(LogSink &out, int count, const function<void(int, int, LogSink &)> &query)
+{
+	ThreadPool &pool = defaultPool();
+	int wave = pool.size() * BATCH_WAVE;
+
+	// One memory sink per query of a wave, reused by the next wave
+	vector<LogSink> buffers(min(count, wave));
+	for (auto &buffer : buffers)
+		buffer.openMemory();
+
+	for (int first = 0; first < count; first += wave)
+	{
+		int n = min(wave, count - first);
+		pool.parallelFor(n, [&](int i, int worker)
+		{
+			buffers[i].clear();
+			query(first + i, worker, buffers[i]);
+		});
+
+		// Input order, whichever query finished first
+		for (int i = 0; i < n; i++)
+			out.write(buffers[i].text(), buffers[i].length());
+	}
+}
+
+void Manager::writeErrorCode(LogSink &out, int n)
+{
+	out << "========ERROR=======" << endl;
+	out << n << endl;
+	out << "====================" << endl;
+	out << endl;
+}
+
+void Manager::printErrorCode(LogSink &out, int n)
+{
+	writeErrorCode(out, n);
+	// Errors reach the file right away
+	out.flush();
+}
+
+const QueueStats &Manager::getQueueStats()
 {
-	fout << "========ERROR=======" << endl;
-	fout << n << endl;
-	fout << "====================" << endl;
-	fout << endl;
+	return queueStats;
 }
\ No newline at end of file
@@ -2,31 +2,85 @@
 #define _MANAGER_H_
 
 #include "GraphMethod.h"
+#include "Stats.h"
+#include "DynamicSssp.h"
+#include "DynamicMst.h"
+#include <functional>
+#include <mutex>
+
+// One command line parsed from the command stream
+struct Command
+{
+	string name;
+	int error;			// Code to report instead of running, 0 when the arguments are fine
+	char option;
+	string text;		// File name or STATS mode
+	vector<int> args;	// Vertices, weights or batch queries
+};
 
 class Manager
 {
 private:
 	Graph *graph;
-	ofstream fout;
+	LogSink fout; // Buffered log.txt, written by a background thread
 	int load;
+	bool useCsr; // Convert loaded graph to CsrGraph (DS_GRAPH_BACKEND=csr)
+	ApspCache cache; // All-pairs results for the loaded graph
+	GraphProfile profile; // Edge weight range of the loaded graph
+	QueueStats queueStats; // Dijkstra queue counters summed over the run
+	StatsRecorder stats; // Per-command timing and counters (STATS ON / DS_STATS)
+	DynamicSssp sssp; // Tree of the last DIJKSTRA, kept current across edge changes
+	DynamicMst mst; // Spanning forest behind KRUSKAL, kept current across edge changes
+	mutex treeLock; // Guards sssp, mst and queueStats for commands running side by side
+
+	bool changeEdge(LogSink &out, int code, int from, int to, bool remove, int weight);
+	// Runs query(index, worker, buffer) for index in [0, count) on defaultPool(),
+	// writing each buffer to out in index order
+	void runBatch(LogSink &out, int count, const function<void(int, int, LogSink &)> &query);
+	void runPipelined(istream &fin);
+	void runGroup(const vector<Command> &group);
 
 public:
-	Manager();
+	Manager(const char *log_txt = "log.txt");	// nullptr keeps no log file (server modes)
 	~Manager();
 
 	void run(const char *command_txt);
 
-	bool LOAD(const char *filename);
-	bool PRINT();
-	bool mBFS(char option, int vertex);
-	bool mDFS(char option, int vertex);
-	bool mDIJKSTRA(char option, int vertex);
-	bool mKRUSKAL();
-	bool mBELLMANFORD(char option, int s_vertex, int e_vertex);
-	bool mFLOYD(char option);
-	bool mCentrality();
-	bool EXIT();
-	void printErrorCode(int n);
+	// Parses the next command, false at the end of the stream
+	static bool readCommand(istream &fin, Command &cmd);
+	// Commands that may run beside their neighbours (DS_PIPELINE=1)
+	static bool isReadOnly(const Command &cmd);
+	// Read-only commands that use the thread pool themselves and run alone instead
+	static bool isParallel(const Command &cmd);
+	// Runs one command, its log block goes to out
+	void execute(const Command &cmd, LogSink &out);
+	// execute() measured on its own while STATS is on, for server clients
+	void executeMeasured(const Command &cmd, LogSink &out);
+	bool measuring() const;
+
+	bool LOAD(LogSink &out, const char *filename);
+	bool SAVE(LogSink &out, const char *filename);
+	bool PRINT(LogSink &out);
+	bool mBFS(LogSink &out, char option, int vertex);
+	bool mDFS(LogSink &out, char option, int vertex);
+	bool mREACH(LogSink &out, char option, int vertex);
+	bool mDIJKSTRA(LogSink &out, char option, int vertex);
+	bool mDIJKSTRABATCH(LogSink &out, char option, const vector<int> &sources);
+	bool mKRUSKAL(LogSink &out);
+	bool mBELLMANFORD(LogSink &out, char option, int s_vertex, int e_vertex);
+	bool mBELLMANFORDBATCH(LogSink &out, char option, const vector<int> &pairs);	// s1 e1 s2 e2 ...
+	bool mPATH(LogSink &out, char option, int s_vertex, int e_vertex);
+	bool mFLOYD(LogSink &out, char option);
+	bool mCentrality(LogSink &out);
+	bool mSTATS(LogSink &out, const string &mode);
+	bool mINSERTEDGE(LogSink &out, int from, int to, int weight);
+	bool mDELETEEDGE(LogSink &out, int from, int to);
+	bool mUPDATEEDGE(LogSink &out, int from, int to, int weight);
+	bool EXIT(LogSink &out);
+	void printErrorCode(LogSink &out, int n);
+	static void writeErrorCode(LogSink &out, int n);
+
+	const QueueStats &getQueueStats();
 };
 
 #endif
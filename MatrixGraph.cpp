@@ -1,73 +1,138 @@
 #include "MatrixGraph.h"
+#include "SimdScan.h"
 #include <iostream>
 #include <vector>
 #include <string>
+#include <stdint.h>
+
+// Alignment of each matrix buffer in bytes (one cache line)
+static const int MATRIX_ALIGN = 64;
 
 MatrixGraph::MatrixGraph(bool type, int size) : Graph(type, size)
 {
-    // Allocate a size x size adjacency matrix
-    m_Mat = new int *[m_Size];
-    for (int i = 0; i < m_Size; i++)
-    {
-        m_Mat[i] = new int[m_Size];
-        // Initialize all entries to 0
-        for (int j = 0; j < m_Size; j++)
-        {
-            m_Mat[i][j] = 0;
-        }
-    }
+    // Pad rows so the SIMD scan always reads whole blocks
+    m_Stride = (m_Size + SCAN_BLOCK - 1) / SCAN_BLOCK * SCAN_BLOCK;
+
+    // Allocate a size x size adjacency matrix and its transpose, all entries 0
+    m_Mat = allocAligned(m_MatBase);
+    m_Trans = allocAligned(m_TransBase);
+    m_OutDeg.assign(m_Size, 0);
+    m_InDeg.assign(m_Size, 0);
 }
 
 MatrixGraph::~MatrixGraph()
 {
     // Release allocated adjacency matrix
-    for (int i = 0; i < m_Size; i++)
-    {
-        delete[] m_Mat[i];
-    }
-    delete[] m_Mat;
+    delete[] m_MatBase;
+    delete[] m_TransBase;
+}
+
+int *MatrixGraph::allocAligned(int *&base)
+{
+    size_t cells = (size_t)m_Size * m_Stride + MATRIX_ALIGN / sizeof(int);
+    base = new int[cells]();
+
+    // Round the start up to the next MATRIX_ALIGN boundary
+    uintptr_t addr = (uintptr_t)base;
+    addr = (addr + MATRIX_ALIGN - 1) & ~(uintptr_t)(MATRIX_ALIGN - 1);
+    return (int *)addr;
 }
 
 void MatrixGraph::getAdjacentEdges(int vertex, map<int, int> *m)
 {
-    // Add outgoing edges
-    for (int i = 0; i < m_Size; i++)
+    const int *out = m_Mat + (size_t)vertex * m_Stride;
+    const int *in = m_Trans + (size_t)vertex * m_Stride;
+
+    // Add outgoing edges, then incoming edges
+    for (int base = 0; base < m_Stride; base += SCAN_BLOCK)
     {
-        if (m_Mat[vertex][i] != 0)
+        for (unsigned mask = nonZeroMask(out + base); mask; mask &= mask - 1)
         {
-            (*m)[i] = m_Mat[vertex][i];
+            int i = base + lowestBit(mask);
+            (*m)[i] = out[i];
         }
     }
-
-    // Add incoming edges
-    for (int i = 0; i < m_Size; i++)
+    for (int base = 0; base < m_Stride; base += SCAN_BLOCK)
     {
-        if (m_Mat[i][vertex] != 0)
+        for (unsigned mask = nonZeroMask(in + base); mask; mask &= mask - 1)
         {
-            (*m)[i] = m_Mat[i][vertex];
+            int i = base + lowestBit(mask);
+            (*m)[i] = in[i];
         }
     }
 }
 
 void MatrixGraph::getAdjacentEdgesDirect(int vertex, map<int, int> *m)
 {
+    const int *out = m_Mat + (size_t)vertex * m_Stride;
+
     // Add outgoing edges
-    for (int i = 0; i < m_Size; i++)
+    for (int base = 0; base < m_Stride; base += SCAN_BLOCK)
     {
-        if (m_Mat[vertex][i] != 0)
+        for (unsigned mask = nonZeroMask(out + base); mask; mask &= mask - 1)
         {
-            (*m)[i] = m_Mat[vertex][i];
+            int i = base + lowestBit(mask);
+            (*m)[i] = out[i];
         }
     }
 }
 
 void MatrixGraph::insertEdge(int from, int to, int weight)
 {
-    // Insert edge weight
-    m_Mat[from][to] = weight;
+    // Track degrees when a cell turns on or off
+    int old = m_Mat[(size_t)from * m_Stride + to];
+    if (old == 0 && weight != 0)
+    {
+        m_OutDeg[from]++;
+        m_InDeg[to]++;
+    }
+    else if (old != 0 && weight == 0)
+    {
+        m_OutDeg[from]--;
+        m_InDeg[to]--;
+    }
+
+    // Insert edge weight into both layouts
+    m_Mat[(size_t)from * m_Stride + to] = weight;
+    m_Trans[(size_t)to * m_Stride + from] = weight;
 }
 
-bool MatrixGraph::printGraph(ofstream *fout)
+bool MatrixGraph::removeEdge(int from, int to)
+{
+    if (m_Mat[(size_t)from * m_Stride + to] == 0)
+    {
+        return false;
+    }
+    // Weight 0 is no edge, insertEdge keeps the degrees right
+    insertEdge(from, to, 0);
+    return true;
+}
+
+void MatrixGraph::setCell(int from, int to, int weight)
+{
+    m_Mat[(size_t)from * m_Stride + to] = weight;
+    m_Trans[(size_t)to * m_Stride + from] = weight;
+}
+
+void MatrixGraph::recountDegrees()
+{
+    // Row of m_Mat gives out-degree, row of m_Trans gives in-degree
+    for (int v = 0; v < m_Size; v++)
+    {
+        const int *out = m_Mat + (size_t)v * m_Stride;
+        const int *in = m_Trans + (size_t)v * m_Stride;
+        int outCount = 0, inCount = 0;
+        for (int base = 0; base < m_Stride; base += SCAN_BLOCK)
+        {
+            outCount += __builtin_popcount(nonZeroMask(out + base));
+            inCount += __builtin_popcount(nonZeroMask(in + base));
+        }
+        m_OutDeg[v] = outCount;
+        m_InDeg[v] = inCount;
+    }
+}
+
+bool MatrixGraph::printGraph(LogSink *fout)
 {
     if (!fout || !fout->is_open())
     {
@@ -82,12 +147,92 @@ bool MatrixGraph::printGraph(ofstream *fout)
 
     for (int i = 0; i < m_Size; i++)
     {
+        const int *row = m_Mat + (size_t)i * m_Stride;
         (*fout) << "[" << i << "] ";
         for (int j = 0; j < m_Size; j++)
         {
-            (*fout) << m_Mat[i][j] << "   ";
+            (*fout) << row[j] << "   ";
         }
         (*fout) << "\n";
     }
     return true;
-}
\ No newline at end of file
+}
+
+void MatrixGraph::forEachOutEdge(int vertex, EdgeVisitor &visitor)
+{
+    const int *out = m_Mat + (size_t)vertex * m_Stride;
+
+    for (int base = 0; base < m_Stride; base += SCAN_BLOCK)
+    {
+        for (unsigned mask = nonZeroMask(out + base); mask; mask &= mask - 1)
+        {
+            int i = base + lowestBit(mask);
+            if (!visitor.visit(i, out[i]))
+                return;
+        }
+    }
+}
+
+void MatrixGraph::forEachInEdge(int vertex, EdgeVisitor &visitor)
+{
+    // Column of m_Mat is a contiguous row of m_Trans
+    const int *in = m_Trans + (size_t)vertex * m_Stride;
+
+    for (int base = 0; base < m_Stride; base += SCAN_BLOCK)
+    {
+        for (unsigned mask = nonZeroMask(in + base); mask; mask &= mask - 1)
+        {
+            int i = base + lowestBit(mask);
+            if (!visitor.visit(i, in[i]))
+                return;
+        }
+    }
+}
+
+void MatrixGraph::forEachAdjacentEdge(int vertex, EdgeVisitor &visitor)
+{
+    const int *out = m_Mat + (size_t)vertex * m_Stride;
+    const int *in = m_Trans + (size_t)vertex * m_Stride;
+
+    for (int base = 0; base < m_Stride; base += SCAN_BLOCK)
+    {
+        unsigned mask = nonZeroMask(out + base) | nonZeroMask(in + base);
+        for (; mask; mask &= mask - 1)
+        {
+            int i = base + lowestBit(mask);
+            // Incoming weight wins like getAdjacentEdges
+            int weight = in[i] != 0 ? in[i] : out[i];
+            if (!visitor.visit(i, weight))
+                return;
+        }
+    }
+}
+
+void MatrixGraph::forEachReverseAdjacentEdge(int vertex, EdgeVisitor &visitor)
+{
+    const int *out = m_Mat + (size_t)vertex * m_Stride;
+    const int *in = m_Trans + (size_t)vertex * m_Stride;
+
+    for (int base = 0; base < m_Stride; base += SCAN_BLOCK)
+    {
+        unsigned mask = nonZeroMask(out + base) | nonZeroMask(in + base);
+        for (; mask; mask &= mask - 1)
+        {
+            int i = base + lowestBit(mask);
+            // Neighbor i sees vertex with its outgoing weight when it exists
+            int weight = out[i] != 0 ? out[i] : in[i];
+            if (!visitor.visit(i, weight))
+                return;
+        }
+    }
+}
+
+int MatrixGraph::outDegree(int vertex)
+{
+    return m_OutDeg[vertex];
+}
+
+int MatrixGraph::inDegree(int vertex)
+{
+    return m_InDeg[vertex];
+}
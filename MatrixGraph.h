@@ -5,7 +5,15 @@
 
 class MatrixGraph : public Graph{	
 private:
-	int** m_Mat;
+	int m_Stride;		// Row length in ints, padded to a multiple of SCAN_BLOCK
+	int *m_Mat;			// Row-major weights, m_Mat[from * m_Stride + to]
+	int *m_Trans;		// Column-major mirror, m_Trans[to * m_Stride + from]
+	int *m_MatBase;		// Unaligned allocations backing m_Mat / m_Trans
+	int *m_TransBase;
+	vector<int> m_OutDeg;	// Nonzero cells per row
+	vector<int> m_InDeg;	// Nonzero cells per column
+
+	int *allocAligned(int *&base);
 
 public:
 	MatrixGraph(bool type, int size);
@@ -14,7 +22,19 @@ public:
 	void getAdjacentEdges(int vertex, map<int, int>* m);	
 	void getAdjacentEdgesDirect(int vertex, map<int, int>* m);
 	void insertEdge(int from, int to, int weight);	
-	bool printGraph(ofstream *fout);
+	bool removeEdge(int from, int to);
+	bool printGraph(LogSink *fout);
+	void forEachOutEdge(int vertex, EdgeVisitor &visitor);
+	void forEachInEdge(int vertex, EdgeVisitor &visitor);
+	void forEachAdjacentEdge(int vertex, EdgeVisitor &visitor);
+	void forEachReverseAdjacentEdge(int vertex, EdgeVisitor &visitor);
+	int outDegree(int vertex);
+	int inDegree(int vertex);
+
+	// Bulk loading: setCell skips the degree counters, so distinct cells may be set
+	// from different threads. Call recountDegrees once every cell is written.
+	void setCell(int from, int to, int weight);
+	void recountDegrees();
 };
 
-#endif
\ No newline at end of file
+#endif
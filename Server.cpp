@@ -0,0 +1,164 @@
+#include "Server.h"
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <thread>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+// Pending connections the listening socket queues
+static const int LISTEN_BACKLOG = 64;
+
+// Unbuffered-descriptor input for istream, so readCommand works on a socket
+class FdReader : public streambuf
+{
+private:
+    int m_Fd;
+    char m_Buffer[1 << 16];
+
+protected:
+    int_type underflow()
+    {
+        if (gptr() < egptr())
+        {
+            return traits_type::to_int_type(*gptr());
+        }
+
+        ssize_t got;
+        do
+        {
+            got = ::read(m_Fd, m_Buffer, sizeof(m_Buffer));
+        } while (got < 0 && errno == EINTR);
+        if (got <= 0)
+        {
+            return traits_type::eof();
+        }
+
+        setg(m_Buffer, m_Buffer, m_Buffer + got);
+        return traits_type::to_int_type(*gptr());
+    }
+
+public:
+    FdReader(int fd) : m_Fd(fd) {}
+};
+
+CommandServer::CommandServer(Manager &manager) : m_Manager(manager)
+{
+    pthread_rwlock_init(&m_Lock, nullptr);
+}
+
+CommandServer::~CommandServer()
+{
+    pthread_rwlock_destroy(&m_Lock);
+}
+
+void CommandServer::executeLocked(const Command &cmd, LogSink &out)
+{
+    if (Manager::isReadOnly(cmd))
+    {
+        // Readers share the graph unless STATS wants each command measured alone
+        pthread_rwlock_rdlock(&m_Lock);
+        if (!m_Manager.measuring())
+        {
+            m_Manager.execute(cmd, out);
+            pthread_rwlock_unlock(&m_Lock);
+            return;
+        }
+        pthread_rwlock_unlock(&m_Lock);
+    }
+
+    pthread_rwlock_wrlock(&m_Lock);
+    m_Manager.executeMeasured(cmd, out);
+    pthread_rwlock_unlock(&m_Lock);
+}
+
+void CommandServer::serve(istream &in, LogSink &out)
+{
+    Command cmd;
+    while (Manager::readCommand(in, cmd))
+    {
+        executeLocked(cmd, out);
+        // The client waits for this block before sending more
+        out.flush();
+        if (cmd.name == "EXIT")
+        {
+            break;
+        }
+    }
+}
+
+bool CommandServer::serveStdin()
+{
+    // A duplicate, so closing the sink leaves stdout itself open
+    LogSink out;
+    if (!out.attach(dup(STDOUT_FILENO)))
+    {
+        return false;
+    }
+
+    serve(cin, out);
+    out.close();
+    return true;
+}
+
+void CommandServer::serveClient(int fd)
+{
+    FdReader reader(fd);
+    istream in(&reader);
+
+    // Response stream owns the descriptor and closes the connection
+    LogSink out;
+    out.attach(fd);
+    serve(in, out);
+    out.close();
+}
+
+bool CommandServer::listenUnix(const char *path)
+{
+    sockaddr_un addr;
+    if (strlen(path) >= sizeof(addr.sun_path))
+    {
+        return false;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0)
+    {
+        return false;
+    }
+
+    // Replace a socket file left by an earlier run
+    unlink(path);
+    if (bind(listener, (sockaddr *)&addr, sizeof(addr)) < 0 || listen(listener, LISTEN_BACKLOG) < 0)
+    {
+        ::close(listener);
+        return false;
+    }
+
+    // A client that hangs up early must not kill the server on the next write
+    signal(SIGPIPE, SIG_IGN);
+
+    while (true)
+    {
+        int fd = accept(listener, nullptr, nullptr);
+        if (fd < 0)
+        {
+            if (errno == EINTR || errno == ECONNABORTED)
+            {
+                continue;
+            }
+            break;
+        }
+
+        // One thread per client, read-only commands of different clients overlap
+        thread(&CommandServer::serveClient, this, fd).detach();
+    }
+
+    ::close(listener);
+    unlink(path);
+    return false;
+}
@@ -0,0 +1,31 @@
+#ifndef _SERVER_H_
+#define _SERVER_H_
+
+#include "Manager.h"
+#include <pthread.h>
+
+// Keeps one Manager and its loaded graph resident and answers the command.txt language
+// over stdin or a Unix domain socket. Every command's log block is its response, flushed
+// as soon as the command finishes. Read-only commands of different clients run side by
+// side under a shared lock; LOAD, SAVE, STATS and edge changes wait and run alone.
+class CommandServer
+{
+private:
+	Manager &m_Manager;
+	pthread_rwlock_t m_Lock;	// Shared for read-only commands, exclusive for the rest
+
+	void executeLocked(const Command &cmd, LogSink &out);
+	void serveClient(int fd);
+
+public:
+	CommandServer(Manager &manager);
+	~CommandServer();
+
+	// Answers commands from in until EXIT or the end of the stream
+	void serve(istream &in, LogSink &out);
+	bool serveStdin();
+	// Accepts clients on path until the process is stopped, false when the socket cannot be set up
+	bool listenUnix(const char *path);
+};
+
+#endif
@@ -0,0 +1,414 @@
+#include "ShortestPath.h"
+#include "ThreadPool.h"
+#include "Stats.h"
+#include <climits>
+#include <tuple>
+#include <deque>
+
+// Distance of unreached vertices inside the search workspace
+static const long long UNREACHED = LLONG_MAX;
+
+// Buffers reused by one worker across all of its sources
+struct DijkstraWorkspace
+{
+    vector<long long> dist;
+    vector<pair<long long, int>> heap;
+};
+
+// Dijkstra from source on weights w(u, v) + potential[u] - potential[v] (all >= 0).
+// potential may be empty for plain weights. Returns the true distance sum.
+static DistanceSum sumFrom(Graph *graph, char option, int source, const vector<long long> &potential, DijkstraWorkspace &ws)
+{
+    int n = graph->getSize();
+    bool reweight = !potential.empty();
+    greater<pair<long long, int>> later;
+
+    ws.dist.assign(n, UNREACHED);
+    ws.heap.clear();
+
+    ws.dist[source] = 0;
+    ws.heap.push_back(make_pair(0LL, source));
+
+    while (!ws.heap.empty())
+    {
+        pop_heap(ws.heap.begin(), ws.heap.end(), later);
+        long long cost = ws.heap.back().first;
+        int cur = ws.heap.back().second;
+        ws.heap.pop_back();
+
+        STAT_ADD(STAT_POPS, 1);
+
+        // Skip outdated entries
+        if (cost > ws.dist[cur])
+            continue;
+        STAT_ADD(STAT_SETTLED, 1);
+
+        forEachEdge(graph, cur, option, [&](int next, int w)
+        {
+            STAT_ADD(STAT_RELAXED, 1);
+            long long cand = cost + w;
+            if (reweight)
+                cand += potential[cur] - potential[next];
+            if (cand < ws.dist[next])
+            {
+                ws.dist[next] = cand;
+                STAT_ADD(STAT_PUSHES, 1);
+                ws.heap.push_back(make_pair(cand, next));
+                push_heap(ws.heap.begin(), ws.heap.end(), later);
+            }
+            return true;
+        });
+    }
+
+    // Accumulate only the row sum, undoing the reweighting
+    DistanceSum result = {0, true};
+    for (int v = 0; v < n; v++)
+    {
+        if (v == source)
+            continue;
+        if (ws.dist[v] == UNREACHED)
+        {
+            result.reachAll = false;
+            break;
+        }
+        long long d = ws.dist[v];
+        if (reweight)
+            d += potential[v] - potential[source];
+        result.sum += (int)d;
+    }
+    return result;
+}
+
+// Bellman-Ford from a virtual source joined to every vertex by 0-weight edges.
+// Returns false on negative cycle.
+static bool johnsonPotential(Graph *graph, char option, vector<long long> &h)
+{
+    int n = graph->getSize();
+    vector<tuple<int, int, int>> edges;
+    for (int u = 0; u < n; u++)
+    {
+        forEachEdge(graph, u, option, [&](int v, int w)
+        {
+            edges.push_back(make_tuple(u, v, w));
+            return true;
+        });
+    }
+
+    h.assign(n, 0);
+
+    // n + 1 vertices, so a change in round n means a negative cycle
+    for (int round = 0; round <= n; round++)
+    {
+        bool updated = false;
+        for (auto &ed : edges)
+        {
+            int u, v, w;
+            tie(u, v, w) = ed;
+            if (h[v] > h[u] + w)
+            {
+                h[v] = h[u] + w;
+                updated = true;
+            }
+        }
+        if (!updated)
+            return true;
+    }
+    return false;
+}
+
+bool allSourceDistanceSums(Graph *graph, char option, vector<DistanceSum> &result)
+{
+    int n = graph->getSize();
+
+    // Check negative edges. In the undirected view a negative arc u -> v and its reverse
+    // arc v -> u summing below zero are already a negative cycle, nothing to reweight.
+    bool negative = false, twoCycle = false;
+    for (int u = 0; u < n && !twoCycle; u++)
+    {
+        forEachEdge(graph, u, option, [&](int v, int w)
+        {
+            if (w >= 0)
+                return true;
+            negative = true;
+            if (option != 'O')
+            {
+                forEachEdge(graph, v, option, [&](int x, int back)
+                {
+                    if (x == u)
+                        twoCycle = w + back < 0;
+                    return x < u;
+                });
+            }
+            return !twoCycle;
+        });
+    }
+    if (twoCycle)
+    {
+        return false;
+    }
+
+    // The undirected view is not symmetric: a pair joined both ways reports each arc
+    // with the incoming weight, so e.g. 0 -> 1 (-1) with 1 -> 0 (5) has no negative
+    // cycle and still needs Johnson reweighting
+    vector<long long> potential;
+    if (negative && !johnsonPotential(graph, option, potential))
+    {
+        return false;
+    }
+
+    // One independent search per source, one workspace per thread
+    ThreadPool &pool = defaultPool();
+    vector<DijkstraWorkspace> workspace(pool.size());
+    result.assign(n, DistanceSum());
+
+    pool.parallelFor(n, [&](int source, int worker)
+    {
+        result[source] = sumFrom(graph, option, source, potential, workspace[worker]);
+    });
+    return true;
+}
+
+// State of one search direction
+struct SearchSide
+{
+    vector<long long> dist;
+    vector<int> link;                   // Previous vertex toward the search root
+    vector<pair<long long, int>> heap;
+    long long last;                     // Key of the latest settled vertex
+};
+
+bool bidirectionalDijkstra(Graph *graph, char option, int from, int to, vector<int> &path, long long &cost)
+{
+    int n = graph->getSize();
+    greater<pair<long long, int>> later;
+
+    path.clear();
+    if (from == to)
+    {
+        path.push_back(from);
+        cost = 0;
+        return true;
+    }
+
+    SearchSide side[2];     // [0] forward from `from`, [1] backward from `to`
+    int root[2] = {from, to};
+    for (int d = 0; d < 2; d++)
+    {
+        side[d].dist.assign(n, UNREACHED);
+        side[d].link.assign(n, -1);
+        side[d].dist[root[d]] = 0;
+        side[d].heap.push_back(make_pair(0LL, root[d]));
+        side[d].last = 0;
+    }
+
+    // Best known from -> to cost and the arc (meetF -> meetB) where the searches join
+    long long best = UNREACHED;
+    int meetF = -1, meetB = -1;
+
+    int d = 0;
+    while (!side[0].heap.empty() && !side[1].heap.empty())
+    {
+        SearchSide &cur = side[d];
+        SearchSide &other = side[1 - d];
+
+        pop_heap(cur.heap.begin(), cur.heap.end(), later);
+        long long key = cur.heap.back().first;
+        int u = cur.heap.back().second;
+        cur.heap.pop_back();
+        STAT_ADD(STAT_POPS, 1);
+
+        // Skip outdated entries
+        if (key > cur.dist[u])
+            continue;
+        cur.last = key;
+        STAT_ADD(STAT_SETTLED, 1);
+
+        // Early exit, no unsettled vertex can close a shorter path
+        if (best != UNREACHED && side[0].last + side[1].last >= best)
+            break;
+
+        auto relax = [&](int v, int w)
+        {
+            STAT_ADD(STAT_RELAXED, 1);
+            long long cand = key + w;
+            if (cand < cur.dist[v])
+            {
+                STAT_ADD(STAT_PUSHES, 1);
+                cur.dist[v] = cand;
+                cur.link[v] = u;
+                cur.heap.push_back(make_pair(cand, v));
+                push_heap(cur.heap.begin(), cur.heap.end(), later);
+            }
+            // Candidate path through arc u - v
+            if (other.dist[v] != UNREACHED && key + w + other.dist[v] < best)
+            {
+                best = key + w + other.dist[v];
+                meetF = d == 0 ? u : v;
+                meetB = d == 0 ? v : u;
+            }
+            return true;
+        };
+
+        if (d == 0)
+            forEachEdge(graph, u, option, relax);
+        else
+            forEachReverseEdge(graph, u, option, relax);
+
+        d = 1 - d;
+    }
+
+    if (best == UNREACHED)
+        return false;
+
+    // from ... meetF by forward links, then meetB ... to by backward links
+    for (int v = meetF; v != -1; v = side[0].link[v])
+        path.push_back(v);
+    reverse(path.begin(), path.end());
+    for (int v = meetB; v != -1; v = side[1].link[v])
+        path.push_back(v);
+
+    // Zero-weight cycles can make the two halves cross, cut such loops out
+    vector<int> &slot = side[0].link;
+    slot.assign(n, -1);
+    int len = 0;
+    for (int i = 0; i < (int)path.size(); i++)
+    {
+        int v = path[i];
+        if (slot[v] >= 0)
+        {
+            for (int j = slot[v] + 1; j < len; j++)
+                slot[path[j]] = -1;
+            len = slot[v] + 1;
+            continue;
+        }
+        slot[v] = len;
+        path[len++] = v;
+    }
+    path.resize(len);
+
+    cost = best;
+    return true;
+}
+
+// SPFA with SLF/LLL, fills dist only. Returns false on negative cycle.
+static bool spfa(Graph *graph, char option, int source, vector<int> &dist)
+{
+    int n = graph->getSize();
+    vector<int> edges(n, 0);    // Edges on the current tentative path to each vertex
+    vector<char> queued(n, 0);
+    deque<int> Q;
+    long long queuedSum = 0;    // Sum of dist over queued vertices, for LLL
+
+    dist.assign(n, INF);
+    dist[source] = 0;
+    Q.push_back(source);
+    queued[source] = 1;
+
+    bool cycle = false;
+    while (!Q.empty() && !cycle)
+    {
+        // Large-Label-Last: rotate labels above the queue average to the back
+        for (size_t tries = Q.size(); tries > 1 && (long long)dist[Q.front()] * (long long)Q.size() > queuedSum; tries--)
+        {
+            Q.push_back(Q.front());
+            Q.pop_front();
+        }
+
+        int u = Q.front();
+        Q.pop_front();
+        queued[u] = 0;
+        queuedSum -= dist[u];
+        STAT_ADD(STAT_POPS, 1);
+        STAT_ADD(STAT_SETTLED, 1);
+
+        // Only vertices updated since their last visit get here
+        forEachEdge(graph, u, option, [&](int v, int w)
+        {
+            STAT_ADD(STAT_RELAXED, 1);
+            if (dist[v] > dist[u] + w)
+            {
+                if (queued[v])
+                    queuedSum -= dist[v];
+                dist[v] = dist[u] + w;
+                edges[v] = edges[u] + 1;
+
+                // A simple path has at most n - 1 edges
+                if (edges[v] >= n)
+                {
+                    cycle = true;
+                    return false;
+                }
+
+                if (queued[v])
+                {
+                    queuedSum += dist[v];
+                }
+                else
+                {
+                    // Small-Label-First: smaller than the head goes to the front
+                    if (!Q.empty() && dist[v] < dist[Q.front()])
+                        Q.push_front(v);
+                    else
+                        Q.push_back(v);
+                    STAT_ADD(STAT_PUSHES, 1);
+                    queued[v] = 1;
+                    queuedSum += dist[v];
+                }
+            }
+            return true;
+        });
+    }
+    return !cycle;
+}
+
+// Moment the edge sweep would relax an edge: (sweep, from, rank of edge in from's list)
+typedef tuple<int, int, int> SweepTime;
+
+bool bellmanfordTree(Graph *graph, char option, int source, vector<int> &dist, vector<int> &prev)
+{
+    int n = graph->getSize();
+
+    if (!spfa(graph, option, source, dist))
+        return false;
+
+    // The sweep version sweeps edges sorted by (from, to) and keeps the first edge that
+    // reaches the final distance of v. That edge is tight, and it is the first tight edge
+    // (u, v) seen after dist[u] became final. Replay those moments with a Dijkstra on time.
+    prev.assign(n, -1);
+    vector<SweepTime> when(n, SweepTime(INT_MAX, 0, 0));
+    priority_queue<pair<SweepTime, int>, vector<pair<SweepTime, int>>, greater<pair<SweepTime, int>>> pq;
+
+    when[source] = SweepTime(0, -1, -1);
+    pq.push(make_pair(when[source], source));
+
+    while (!pq.empty())
+    {
+        SweepTime t = pq.top().first;
+        int u = pq.top().second;
+        pq.pop();
+
+        // Skip outdated entries
+        if (t != when[u])
+            continue;
+
+        int rank = 0;
+        forEachEdge(graph, u, option, [&](int v, int w)
+        {
+            int r = rank++;
+            if (v == source || dist[u] + w != dist[v])
+                return true;
+
+            // Same sweep if the edge comes after the moment u became final, else the next one
+            bool later = make_pair(u, r) > make_pair(get<1>(t), get<2>(t));
+            SweepTime cand(get<0>(t) + (later ? 0 : 1), u, r);
+            if (cand < when[v])
+            {
+                when[v] = cand;
+                prev[v] = u;
+                pq.push(make_pair(cand, v));
+            }
+            return true;
+        });
+    }
+    return true;
+}
\ No newline at end of file
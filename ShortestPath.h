@@ -0,0 +1,32 @@
+#ifndef _SHORTESTPATH_H_
+#define _SHORTESTPATH_H_
+
+#include "Graph.h"
+
+// Per-source result used by closeness centrality
+struct DistanceSum
+{
+	long long sum;	// Sum of dist(source, v) over every v != source
+	bool reachAll;	// Every other vertex is reachable from source
+};
+
+// Runs one single-source search from every vertex on defaultPool() and keeps only
+// each source's distance sum. Uses Dijkstra when no edge picked by option is negative,
+// otherwise Johnson reweighting (one Bellman-Ford pass, then Dijkstra per source).
+// An undirected arc pair u -> v -> u with a negative sum fails at once without the
+// Bellman-Ford pass. Returns false when a negative cycle exists.
+bool allSourceDistanceSums(Graph *graph, char option, vector<DistanceSum> &result);
+
+// Point-to-point shortest path with bidirectional Dijkstra (weights must be >= 0).
+// The backward search walks the reverse view of option and both searches stop
+// once the best meeting cost cannot improve. Returns false when to is unreachable.
+bool bidirectionalDijkstra(Graph *graph, char option, int from, int to, vector<int> &path, long long &cost);
+
+// Single-source shortest paths that allow negative weights.
+// Distances come from a queue-based Bellman-Ford (SPFA) with Small-Label-First and
+// Large-Label-Last ordering. A negative cycle is reported as soon as some tentative
+// shortest path reaches n edges. prev matches what the edge-sweep Bellman-Ford would
+// pick, so printed paths stay the same. Returns false on a negative cycle reachable from source.
+bool bellmanfordTree(Graph *graph, char option, int source, vector<int> &dist, vector<int> &prev);
+
+#endif
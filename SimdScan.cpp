@@ -0,0 +1,70 @@
+#include "SimdScan.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define SIMDSCAN_X86 1
+#include <immintrin.h>
+#endif
+
+#ifndef SIMDSCAN_X86
+// Portable fallback for non x86-64 targets
+static unsigned nonZeroMaskScalar(const int *block)
+{
+    unsigned mask = 0;
+    for (int i = 0; i < SCAN_BLOCK; i++)
+    {
+        if (block[i] != 0)
+            mask |= 1u << i;
+    }
+    return mask;
+}
+#else
+// SSE2 is part of the x86-64 baseline, 4 ints per compare
+static unsigned nonZeroMaskSse2(const int *block)
+{
+    const __m128i zero = _mm_setzero_si128();
+    unsigned mask = 0;
+    for (int i = 0; i < SCAN_BLOCK; i += 4)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)(block + i));
+        unsigned eq = (unsigned)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(v, zero)));
+        mask |= (~eq & 0xFu) << i;
+    }
+    return mask;
+}
+
+// AVX2, 8 ints per compare
+__attribute__((target("avx2"))) static unsigned nonZeroMaskAvx2(const int *block)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    unsigned mask = 0;
+    for (int i = 0; i < SCAN_BLOCK; i += 8)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(block + i));
+        unsigned eq = (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(v, zero)));
+        mask |= (~eq & 0xFFu) << i;
+    }
+    return mask;
+}
+#endif
+
+typedef unsigned (*NonZeroMaskFn)(const int *);
+
+// Pick the widest kernel the running CPU supports
+static NonZeroMaskFn selectKernel()
+{
+#ifdef SIMDSCAN_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return nonZeroMaskAvx2;
+    return nonZeroMaskSse2;
+#else
+    return nonZeroMaskScalar;
+#endif
+}
+
+static const NonZeroMaskFn kernel = selectKernel();
+
+unsigned nonZeroMask(const int *block)
+{
+    return kernel(block);
+}
@@ -0,0 +1,17 @@
+#ifndef _SIMDSCAN_H_
+#define _SIMDSCAN_H_
+
+// Number of ints examined by one nonZeroMask call
+const int SCAN_BLOCK = 32;
+
+// Bit i of the result is set when block[i] != 0 (block holds SCAN_BLOCK ints).
+// Uses AVX2 or SSE2 when the CPU supports it, scalar code otherwise.
+unsigned nonZeroMask(const int *block);
+
+// Index of the lowest set bit (mask must not be 0)
+inline int lowestBit(unsigned mask)
+{
+	return __builtin_ctz(mask);
+}
+
+#endif
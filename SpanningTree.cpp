@@ -0,0 +1,400 @@
+#include "SpanningTree.h"
+#include "DisjointSet.h"
+#include "ThreadPool.h"
+#include "MatrixGraph.h"
+#include "Stats.h"
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+
+// Ranges at most this long (or the vertex count if larger) are sorted directly
+static const int FILTER_BASE = 1024;
+
+// Leaf ranges at least this long are sorted in parallel
+static const int PARALLEL_SORT_MIN = 1 << 15;
+
+// Smallest directed edge count for which Boruvka is worth the thread pool
+static const long long BORUVKA_MIN_EDGES = 1 << 16;
+
+// Vertices handed to one Boruvka task
+static const int BORUVKA_BLOCK = 1024;
+
+// Sort chunks on the pool, then merge neighbouring runs pairwise
+static void sortEdges(vector<MstEdge>::iterator first, vector<MstEdge>::iterator last)
+{
+    ThreadPool &pool = defaultPool();
+    int count = (int)(last - first);
+    int chunks = pool.size();
+
+    if (count < PARALLEL_SORT_MIN || chunks < 2)
+    {
+        sort(first, last);
+        return;
+    }
+
+    // Run i covers [bound[i], bound[i + 1])
+    vector<int> bound(chunks + 1);
+    for (int i = 0; i <= chunks; i++)
+    {
+        bound[i] = (int)((long long)count * i / chunks);
+    }
+
+    pool.parallelFor(chunks, [&](int i, int)
+    {
+        sort(first + bound[i], first + bound[i + 1]);
+    });
+
+    for (int width = 1; width < chunks; width *= 2)
+    {
+        int pairs = (chunks + 2 * width - 1) / (2 * width);
+        pool.parallelFor(pairs, [&](int p, int)
+        {
+            int lo = p * 2 * width;
+            int mid = min(lo + width, chunks);
+            int hi = min(lo + 2 * width, chunks);
+            if (mid < hi)
+            {
+                inplace_merge(first + bound[lo], first + bound[mid], first + bound[hi]);
+            }
+        });
+    }
+}
+
+// Index of the median of edges[a], edges[b], edges[c]
+static int medianOfThree(const vector<MstEdge> &edges, int a, int b, int c)
+{
+    if (edges[a] < edges[b])
+    {
+        if (edges[b] < edges[c])
+            return b;
+        return edges[a] < edges[c] ? c : a;
+    }
+    if (edges[a] < edges[c])
+        return a;
+    return edges[b] < edges[c] ? c : b;
+}
+
+bool filterKruskal(Graph *graph, vector<MstEdge> &tree)
+{
+    int size = graph->getSize();
+    tree.clear();
+
+    vector<MstEdge> edges;
+
+    // Collect all undirected edges
+    for (int u = 0; u < size; u++)
+    {
+        forEachEdge(graph, u, 'X', [&](int v, int w)
+        {
+            if (u < v)
+            {
+                edges.push_back({w, u, v});
+            }
+            return true;
+        });
+    }
+
+    // Can't make MST
+    if (edges.empty())
+    {
+        return false;
+    }
+
+    DisjointSet sets(size);
+    int base = max(FILTER_BASE, size);
+
+    // Pending ranges, a range pushed with filter set still holds edges that may close a cycle
+    struct Range
+    {
+        int lo, hi;
+        bool filter;
+    };
+    vector<Range> pending;
+    pending.push_back({0, (int)edges.size(), false});
+
+    while (!pending.empty() && (int)tree.size() < size - 1)
+    {
+        Range r = pending.back();
+        pending.pop_back();
+
+        // Drop edges whose endpoints were joined by lighter edges
+        if (r.filter)
+        {
+            r.hi = (int)(partition(edges.begin() + r.lo, edges.begin() + r.hi, [&](const MstEdge &e)
+            {
+                return sets.find(e.u) != sets.find(e.v);
+            }) - edges.begin());
+        }
+
+        if (r.hi - r.lo <= base)
+        {
+            // Plain Kruskal over the sorted leaf
+            sortEdges(edges.begin() + r.lo, edges.begin() + r.hi);
+            for (int i = r.lo; i < r.hi && (int)tree.size() < size - 1; i++)
+            {
+                if (sets.unite(edges[i].u, edges[i].v))
+                {
+                    tree.push_back(edges[i]);
+                }
+            }
+            continue;
+        }
+
+        // Keys are distinct, so both sides are non-empty around a median-of-three pivot
+        MstEdge pivot = edges[medianOfThree(edges, r.lo, r.lo + (r.hi - r.lo) / 2, r.hi - 1)];
+        int mid = (int)(partition(edges.begin() + r.lo, edges.begin() + r.hi, [&](const MstEdge &e)
+        {
+            return e < pivot;
+        }) - edges.begin());
+
+        // Heavier half waits until the lighter half is done
+        pending.push_back({mid, r.hi, true});
+        pending.push_back({r.lo, mid, false});
+    }
+
+    // Check MST has (size - 1) edges
+    return (int)tree.size() == size - 1;
+}
+
+bool primMst(Graph *graph, vector<MstEdge> &tree)
+{
+    int size = graph->getSize();
+    tree.clear();
+
+    // Lightest known edge from the tree to each outside vertex
+    vector<MstEdge> best(size);
+    vector<char> reached(size, 0);
+    vector<char> inTree(size, 0);
+
+    int cur = 0;
+    inTree[cur] = 1;
+
+    while ((int)tree.size() < size - 1)
+    {
+        // Offer the edges of the newest tree vertex
+        forEachMstEdge(graph, cur, [&](int y, int w)
+        {
+            STAT_ADD(STAT_RELAXED, 1);
+            if (inTree[y])
+            {
+                return;
+            }
+            MstEdge e = {w, min(cur, y), max(cur, y)};
+            if (!reached[y] || e < best[y])
+            {
+                best[y] = e;
+                reached[y] = 1;
+            }
+        });
+
+        // Cheapest outside vertex, ties follow the (w, u, v) order
+        int next = -1;
+        for (int v = 0; v < size; v++)
+        {
+            if (!inTree[v] && reached[v] && (next < 0 || best[v] < best[next]))
+            {
+                next = v;
+            }
+        }
+
+        // Not connected
+        if (next < 0)
+        {
+            return false;
+        }
+
+        inTree[next] = 1;
+        STAT_ADD(STAT_SETTLED, 1);
+        tree.push_back(best[next]);
+        cur = next;
+    }
+
+    // A single vertex has no edge to pick
+    return size > 1;
+}
+
+bool boruvkaMst(Graph *graph, vector<MstEdge> &tree)
+{
+    int size = graph->getSize();
+    tree.clear();
+
+    vector<MstEdge> edges;
+    for (int u = 0; u < size; u++)
+    {
+        forEachMstEdge(graph, u, [&](int v, int w)
+        {
+            if (u < v)
+            {
+                edges.push_back({w, u, v});
+            }
+        });
+    }
+
+    // Can't make MST
+    if (edges.empty())
+    {
+        return false;
+    }
+
+    // Edge ids incident to v are incident[offset[v] .. offset[v] + live[v])
+    vector<int> offset(size + 1, 0);
+    for (auto &e : edges)
+    {
+        offset[e.u + 1]++;
+        offset[e.v + 1]++;
+    }
+    for (int v = 0; v < size; v++)
+    {
+        offset[v + 1] += offset[v];
+    }
+    vector<int> incident(offset[size]);
+    vector<int> live(size, 0);
+    for (int id = 0; id < (int)edges.size(); id++)
+    {
+        incident[offset[edges[id].u] + live[edges[id].u]++] = id;
+        incident[offset[edges[id].v] + live[edges[id].v]++] = id;
+    }
+
+    DisjointSet sets(size);
+    vector<int> comp(size);
+    for (int v = 0; v < size; v++)
+    {
+        comp[v] = v;
+    }
+
+    ThreadPool &pool = defaultPool();
+    int blocks = (size + BORUVKA_BLOCK - 1) / BORUVKA_BLOCK;
+    vector<int> vertexBest(size);
+    vector<int> compBest(size);
+
+    while ((int)tree.size() < size - 1)
+    {
+        // Lightest edge leaving each vertex's component, each block owns its vertices' lists
+        pool.parallelFor(blocks, [&](int block, int)
+        {
+            int end = min(size, (block + 1) * BORUVKA_BLOCK);
+            for (int v = block * BORUVKA_BLOCK; v < end; v++)
+            {
+                int found = -1;
+                int *list = &incident[offset[v]];
+                for (int i = 0; i < live[v];)
+                {
+                    const MstEdge &e = edges[list[i]];
+                    int other = e.u == v ? e.v : e.u;
+
+                    // Edge inside the component will never be picked again
+                    if (comp[other] == comp[v])
+                    {
+                        list[i] = list[--live[v]];
+                        continue;
+                    }
+                    if (found < 0 || e < edges[found])
+                    {
+                        found = list[i];
+                    }
+                    i++;
+                }
+                vertexBest[v] = found;
+            }
+        });
+
+        // Reduce to one edge per component
+        fill(compBest.begin(), compBest.end(), -1);
+        for (int v = 0; v < size; v++)
+        {
+            int id = vertexBest[v];
+            int &slot = compBest[comp[v]];
+            if (id >= 0 && (slot < 0 || edges[id] < edges[slot]))
+            {
+                slot = id;
+            }
+        }
+
+        // Keys are distinct, so the picked edges never close a cycle
+        int added = 0;
+        for (int r = 0; r < size; r++)
+        {
+            if (compBest[r] >= 0 && sets.unite(edges[compBest[r]].u, edges[compBest[r]].v))
+            {
+                tree.push_back(edges[compBest[r]]);
+                added++;
+            }
+        }
+
+        // Not connected
+        if (added == 0)
+        {
+            return false;
+        }
+
+        for (int v = 0; v < size; v++)
+        {
+            comp[v] = sets.find(v);
+        }
+    }
+
+    return true;
+}
+
+MstKind chooseMst(Graph *graph, long long edges, int threads)
+{
+    // Manual override
+    const char *env = getenv("DS_MST");
+    if (env)
+    {
+        string name(env);
+        if (name == "kruskal")
+            return MST_KRUSKAL;
+        if (name == "prim")
+            return MST_PRIM;
+        if (name == "boruvka")
+            return MST_BORUVKA;
+    }
+
+    int size = graph->getSize();
+
+    // Matrix rows are scanned whole anyway, and dense graphs make Kruskal sort ~V^2 edges
+    if (dynamic_cast<MatrixGraph *>(graph) || edges >= (long long)size * size / 4)
+        return MST_PRIM;
+    if (threads > 1 && edges >= BORUVKA_MIN_EDGES)
+        return MST_BORUVKA;
+    return MST_KRUSKAL;
+}
+
+const char *mstName(MstKind kind)
+{
+    switch (kind)
+    {
+    case MST_KRUSKAL:
+        return "kruskal";
+    case MST_PRIM:
+        return "prim";
+    case MST_BORUVKA:
+        return "boruvka";
+    default:
+        return "auto";
+    }
+}
+
+bool minimumSpanningTree(Graph *graph, MstKind kind, vector<MstEdge> &tree)
+{
+    if (kind == MST_AUTO)
+    {
+        long long edges = 0;
+        for (int u = 0; u < graph->getSize(); u++)
+        {
+            edges += graph->outDegree(u);
+        }
+        kind = chooseMst(graph, edges, defaultPool().size());
+    }
+
+    switch (kind)
+    {
+    case MST_PRIM:
+        return primMst(graph, tree);
+    case MST_BORUVKA:
+        return boruvkaMst(graph, tree);
+    default:
+        return filterKruskal(graph, tree);
+    }
+}
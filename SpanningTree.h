@@ -0,0 +1,76 @@
+#ifndef _SPANNINGTREE_H_
+#define _SPANNINGTREE_H_
+
+#include "Graph.h"
+
+// Undirected edge with u < v, ordered by (w, u, v) like the original sorted tuple list
+struct MstEdge
+{
+	int w;
+	int u;
+	int v;
+
+	bool operator<(const MstEdge &other) const
+	{
+		if (w != other.w)
+			return w < other.w;
+		if (u != other.u)
+			return u < other.u;
+		return v < other.v;
+	}
+};
+
+// Visit every undirected neighbor y of x once, with the weight Kruskal collects for the pair.
+// The smaller endpoint's adjacent view decides it, which is the larger endpoint's reverse view.
+template <class F>
+void forEachMstEdge(Graph *graph, int x, F visit)
+{
+	forEachEdge(graph, x, 'X', [&](int y, int w)
+	{
+		if (x < y)
+		{
+			visit(y, w);
+		}
+		return true;
+	});
+	forEachReverseEdge(graph, x, 'X', [&](int y, int w)
+	{
+		if (y < x)
+		{
+			visit(y, w);
+		}
+		return true;
+	});
+}
+
+enum MstKind
+{
+	MST_AUTO,
+	MST_KRUSKAL,	// Filter-Kruskal, general default
+	MST_PRIM,		// Array-based O(V^2) Prim for matrix and dense graphs
+	MST_BORUVKA		// Parallel Boruvka for large sparse graphs
+};
+
+// Minimum spanning tree of the undirected view with Filter-Kruskal.
+// Ranges are split around a pivot edge, the lighter side is solved first and
+// heavier edges already inside one component are dropped before they get sorted.
+// Large leaf ranges are sorted on defaultPool(). Picks the same edges as a
+// full-sort Kruskal over (w, u, v). Returns false when the graph has no edges
+// or is not connected.
+bool filterKruskal(Graph *graph, vector<MstEdge> &tree);
+
+// Same tree with Prim, picking the next vertex by a linear scan (no heap).
+bool primMst(Graph *graph, vector<MstEdge> &tree);
+
+// Same tree with Boruvka rounds. Each round finds the lightest edge leaving every
+// vertex on defaultPool(), dropping edges inside one component as it goes.
+bool boruvkaMst(Graph *graph, vector<MstEdge> &tree);
+
+// Engine for a graph with edges directed edges, honoring DS_MST=kruskal|prim|boruvka
+MstKind chooseMst(Graph *graph, long long edges, int threads);
+const char *mstName(MstKind kind);
+
+// Runs the engine picked by kind (MST_AUTO asks chooseMst)
+bool minimumSpanningTree(Graph *graph, MstKind kind, vector<MstEdge> &tree);
+
+#endif
@@ -0,0 +1,183 @@
+#include "Stats.h"
+#include <cstdlib>
+#include <ctime>
+#include <deque>
+#include <mutex>
+#include <sys/resource.h>
+
+// Default stats file for STATS ON and DS_STATS=1
+static const char *STATS_FILE = "stats.txt";
+
+#ifdef DS_STATS
+thread_local long long *t_StatCounters = nullptr;
+
+struct StatBlock
+{
+    long long value[STAT_COUNT];
+};
+
+// Counter blocks of every thread that bumped one, deque keeps addresses stable
+static mutex s_StatLock;
+static deque<StatBlock> s_StatBlocks;
+
+long long *statRegister()
+{
+    lock_guard<mutex> lock(s_StatLock);
+    s_StatBlocks.push_back(StatBlock());
+    return s_StatBlocks.back().value;
+}
+#endif
+
+void statTotals(long long totals[STAT_COUNT])
+{
+    for (int c = 0; c < STAT_COUNT; c++)
+    {
+        totals[c] = 0;
+    }
+#ifdef DS_STATS
+    // Workers are idle between commands, so the blocks are stable here
+    lock_guard<mutex> lock(s_StatLock);
+    for (auto &block : s_StatBlocks)
+    {
+        for (int c = 0; c < STAT_COUNT; c++)
+        {
+            totals[c] += block.value[c];
+        }
+    }
+#endif
+}
+
+const char *statName(StatCounter counter)
+{
+    switch (counter)
+    {
+    case STAT_SETTLED:
+        return "settled";
+    case STAT_RELAXED:
+        return "relaxed";
+    case STAT_PUSHES:
+        return "pushes";
+    case STAT_POPS:
+        return "pops";
+    case STAT_UNION_FIND:
+        return "union_find";
+    case STAT_FLOYD_INNER:
+        return "floyd_inner";
+    default:
+        return "unknown";
+    }
+}
+
+// Seconds on the given clock
+static double clockSeconds(clockid_t clock)
+{
+    timespec now;
+    clock_gettime(clock, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+// Peak resident set size so far in KB
+static long peakRss()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+StatsRecorder::StatsRecorder()
+{
+    m_File = nullptr;
+    m_Enabled = false;
+    m_Open = false;
+    m_Index = 0;
+    m_Path = STATS_FILE;
+
+    // DS_STATS turns recording on from the first command
+    const char *env = getenv("DS_STATS");
+    if (env != nullptr)
+    {
+        if (env[0] != '\0' && string(env) != "1")
+        {
+            m_Path = env;
+        }
+        enable();
+    }
+}
+
+StatsRecorder::~StatsRecorder()
+{
+    end();
+    if (m_File)
+    {
+        fclose(m_File);
+    }
+}
+
+bool StatsRecorder::enable()
+{
+    // The file is truncated once per run, like log.txt
+    if (m_File == nullptr)
+    {
+        m_File = fopen(m_Path.c_str(), "w");
+        if (m_File == nullptr)
+        {
+            return false;
+        }
+    }
+    m_Enabled = true;
+    return true;
+}
+
+void StatsRecorder::disable()
+{
+    m_Enabled = false;
+    m_Open = false;
+}
+
+bool StatsRecorder::enabled() const
+{
+    return m_Enabled;
+}
+
+void StatsRecorder::begin(const string &command)
+{
+    m_Index++;
+    if (!m_Enabled)
+    {
+        return;
+    }
+
+    m_Open = true;
+    m_Command = command;
+    statTotals(m_Counters);
+    m_Rss = peakRss();
+    m_Cpu = clockSeconds(CLOCK_PROCESS_CPUTIME_ID);
+    m_Wall = clockSeconds(CLOCK_MONOTONIC);
+}
+
+void StatsRecorder::end()
+{
+    if (!m_Open)
+    {
+        return;
+    }
+    m_Open = false;
+
+    double wall = clockSeconds(CLOCK_MONOTONIC) - m_Wall;
+    double cpu = clockSeconds(CLOCK_PROCESS_CPUTIME_ID) - m_Cpu;
+    long rss = peakRss() - m_Rss;
+
+    fprintf(m_File, "index=%d command=%s wall_ms=%.3f cpu_ms=%.3f peak_rss_delta_kb=%ld",
+            m_Index, m_Command.c_str(), wall * 1000, cpu * 1000, rss);
+
+#ifdef DS_STATS
+    long long totals[STAT_COUNT];
+    statTotals(totals);
+    for (int c = 0; c < STAT_COUNT; c++)
+    {
+        fprintf(m_File, " %s=%lld", statName((StatCounter)c), totals[c] - m_Counters[c]);
+    }
+#endif
+    fprintf(m_File, "\n");
+    fflush(m_File);
+}
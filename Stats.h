@@ -0,0 +1,69 @@
+#ifndef _STATS_H_
+#define _STATS_H_
+
+#include <string>
+#include <cstdio>
+
+using namespace std;
+
+// Algorithm counters, compiled in only when built with -DDS_STATS (make STATS=1)
+enum StatCounter
+{
+	STAT_SETTLED,		// Vertices settled / visited
+	STAT_RELAXED,		// Edges examined by a relaxation step
+	STAT_PUSHES,		// Priority queue / worklist pushes
+	STAT_POPS,			// Priority queue / worklist pops
+	STAT_UNION_FIND,	// DisjointSet find and unite calls
+	STAT_FLOYD_INNER,	// Floyd-Warshall inner loop iterations
+	STAT_COUNT
+};
+
+#ifdef DS_STATS
+long long *statRegister();
+extern thread_local long long *t_StatCounters;
+
+// Bumps the calling thread's counter, totals are summed when a command ends
+#define STAT_ADD(counter, amount)                 \
+	do                                            \
+	{                                             \
+		if (!t_StatCounters)                      \
+			t_StatCounters = statRegister();      \
+		t_StatCounters[counter] += (amount);      \
+	} while (0)
+#else
+#define STAT_ADD(counter, amount) ((void)0)
+#endif
+
+// Sum of every thread's counters (all zero without DS_STATS)
+void statTotals(long long totals[STAT_COUNT]);
+const char *statName(StatCounter counter);
+
+// Writes one key=value line per command: wall time, CPU time, peak RSS growth
+// and the counter deltas. Enabled by STATS ON or the DS_STATS environment variable
+// (a file name, or 1 for stats.txt). log.txt is never touched.
+class StatsRecorder
+{
+private:
+	FILE *m_File;
+	string m_Path;
+	bool m_Enabled;
+	bool m_Open;				// A command is being measured
+	int m_Index;				// Command number in command.txt
+	string m_Command;
+	double m_Wall;				// Values at begin()
+	double m_Cpu;
+	long m_Rss;
+	long long m_Counters[STAT_COUNT];
+
+public:
+	StatsRecorder();
+	~StatsRecorder();
+
+	bool enable();				// false when the stats file cannot be opened
+	void disable();
+	bool enabled() const;
+	void begin(const string &command);
+	void end();
+};
+
+#endif
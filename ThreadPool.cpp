@@ -0,0 +1,122 @@
+#include "ThreadPool.h"
+#include <cstdlib>
+
+// Set while a thread executes a parallelFor body, with its worker index
+static thread_local bool insideJob = false;
+static thread_local int currentWorker = 0;
+
+ThreadPool::ThreadPool(int threads)
+{
+    m_Body = nullptr;
+    m_Count = 0;
+    m_Next = 0;
+    m_Active = 0;
+    m_Generation = 0;
+    m_Stop = false;
+
+    // The calling thread is worker 0, spawn the rest
+    for (int i = 1; i < threads; i++)
+    {
+        m_Workers.push_back(thread(&ThreadPool::workerLoop, this, i));
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        lock_guard<mutex> guard(m_Lock);
+        m_Stop = true;
+    }
+    m_Wake.notify_all();
+
+    for (auto &worker : m_Workers)
+    {
+        worker.join();
+    }
+}
+
+int ThreadPool::size()
+{
+    return (int)m_Workers.size() + 1;
+}
+
+void ThreadPool::runIndices(int worker)
+{
+    insideJob = true;
+    currentWorker = worker;
+    // Claim indices until the job is exhausted
+    for (int i = m_Next++; i < m_Count; i = m_Next++)
+    {
+        (*m_Body)(i, worker);
+    }
+    insideJob = false;
+}
+
+void ThreadPool::workerLoop(int worker)
+{
+    unsigned seen = 0;
+    while (true)
+    {
+        {
+            unique_lock<mutex> guard(m_Lock);
+            m_Wake.wait(guard, [&]
+                        { return m_Stop || m_Generation != seen; });
+            if (m_Stop)
+                return;
+            seen = m_Generation;
+        }
+
+        runIndices(worker);
+
+        // Last worker out wakes the submitter
+        lock_guard<mutex> guard(m_Lock);
+        if (--m_Active == 0)
+            m_Done.notify_one();
+    }
+}
+
+void ThreadPool::parallelFor(int count, const function<void(int, int)> &body)
+{
+    // Nested or trivial jobs run inline
+    if (insideJob || m_Workers.empty() || count <= 1)
+    {
+        bool outer = insideJob;
+        insideJob = true;
+        for (int i = 0; i < count; i++)
+            body(i, currentWorker);
+        insideJob = outer;
+        return;
+    }
+
+    lock_guard<mutex> submit(m_Submit);
+    {
+        lock_guard<mutex> guard(m_Lock);
+        m_Body = &body;
+        m_Count = count;
+        m_Next = 0;
+        m_Active = (int)m_Workers.size();
+        m_Generation++;
+    }
+    m_Wake.notify_all();
+
+    // Caller works too, then waits for the others
+    runIndices(0);
+
+    unique_lock<mutex> guard(m_Lock);
+    m_Done.wait(guard, [&]
+                { return m_Active == 0; });
+    m_Body = nullptr;
+}
+
+int configuredThreads()
+{
+    const char *env = getenv("DS_THREADS");
+    int threads = env ? atoi(env) : (int)thread::hardware_concurrency();
+    return threads > 0 ? threads : 1;
+}
+
+ThreadPool &defaultPool()
+{
+    static ThreadPool pool(configuredThreads());
+    return pool;
+}
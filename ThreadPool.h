@@ -0,0 +1,50 @@
+#ifndef _THREADPOOL_H_
+#define _THREADPOOL_H_
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+using namespace std;
+
+// Fixed set of worker threads that run index ranges in parallel
+class ThreadPool
+{
+private:
+	vector<thread> m_Workers;
+	mutex m_Lock;					// Guards the fields below
+	mutex m_Submit;					// One parallelFor at a time
+	condition_variable m_Wake;
+	condition_variable m_Done;
+	const function<void(int, int)> *m_Body;
+	int m_Count;					// Indices in the current job
+	atomic<int> m_Next;				// Next unclaimed index
+	int m_Active;					// Workers still inside the current job
+	unsigned m_Generation;			// Bumped for every new job
+	bool m_Stop;
+
+	void workerLoop(int worker);
+	void runIndices(int worker);
+
+public:
+	ThreadPool(int threads);
+	~ThreadPool();
+
+	int size();	// Number of threads, including the caller
+
+	// Run body(index, worker) for every index in [0, count) and wait for all of them.
+	// worker is in [0, size()) and identifies the thread, for per-thread workspaces.
+	// Calls made from inside a job run serially on the calling thread.
+	void parallelFor(int count, const function<void(int, int)> &body);
+};
+
+// Thread count from DS_THREADS, or the hardware concurrency when unset
+int configuredThreads();
+
+// Process-wide pool sized by configuredThreads()
+ThreadPool &defaultPool();
+
+#endif
@@ -0,0 +1,47 @@
+#!/bin/bash
+# BFS / REACH thread scaling on one graph file.
+# usage: bench/bfs_scaling.sh <graph file> [start vertex] [repeats]
+# Prints CSV: threads,command,seconds (per command, LOAD time excluded)
+
+GRAPH=$1
+START=${2:-0}
+REPEAT=${3:-5}
+RUN=$(cd "$(dirname "$0")/.." && pwd)/run
+
+if [ -z "$GRAPH" ] || [ ! -f "$GRAPH" ]; then
+    echo "usage: $0 <graph file> [start vertex] [repeats]" >&2
+    exit 1
+fi
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+cp "$GRAPH" "$WORK/graph.txt"
+cd "$WORK" || exit 1
+
+# Wall time of one run of command.txt in seconds
+elapsed() {
+    local t0 t1
+    t0=$(date +%s.%N)
+    DS_THREADS=$1 "$RUN" > /dev/null
+    t1=$(date +%s.%N)
+    awk -v a="$t0" -v b="$t1" 'BEGIN { printf "%.6f", b - a }'
+}
+
+echo "threads,command,seconds"
+for CMD in "BFS O" "BFS X" "REACH O" "REACH X"; do
+    for T in 1 2 4 8 16; do
+        # LOAD alone, subtracted from the measurement
+        printf 'LOAD graph.txt\nEXIT\n' > command.txt
+        BASE=$(elapsed "$T")
+
+        {
+            echo "LOAD graph.txt"
+            for i in $(seq "$REPEAT"); do echo "$CMD $START"; done
+            echo "EXIT"
+        } > command.txt
+        TOTAL=$(elapsed "$T")
+
+        awk -v t="$T" -v c="$CMD" -v all="$TOTAL" -v base="$BASE" -v n="$REPEAT" \
+            'BEGIN { printf "%s,%s,%.6f\n", t, c, (all - base) / n }'
+    done
+done
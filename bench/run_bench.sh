@@ -0,0 +1,93 @@
+#!/bin/bash
+# Every command on generated graphs across the list, csr, snapshot and matrix backends.
+# usage: bench/run_bench.sh [output csv]        (make bench writes bench/results.csv)
+# Scales come from the environment:
+#   BENCH_SCALES         vertex counts for sparse graphs  (default "1000 10000 100000")
+#   BENCH_MATRIX_SCALES  vertex counts for M graphs       (default "250 500 1000")
+#   BENCH_DEGREE         average out-degree of sparse graphs (default 8)
+#   BENCH_APSP_MAX       largest V that runs FLOYD / CENTRALITY (default 2000)
+# CSV: backend,model,vertices,edges,command,seconds,edges_per_sec,peak_rss_kb
+# seconds excludes LOAD (the LOAD row is LOAD alone), peak RSS covers the whole run.
+
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+OUT=$(cd "$(dirname "${1:-$ROOT/bench/results.csv}")" && pwd)/$(basename "${1:-results.csv}")
+RUN=$ROOT/run
+GEN=$ROOT/tools/gengraph
+MEASURE=$ROOT/tools/benchrun
+
+SCALES=${BENCH_SCALES:-"1000 10000 100000"}
+MATRIX_SCALES=${BENCH_MATRIX_SCALES:-"250 500 1000"}
+DEGREE=${BENCH_DEGREE:-8}
+APSP_MAX=${BENCH_APSP_MAX:-2000}
+
+for BIN in "$RUN" "$GEN" "$MEASURE"; do
+    if [ ! -x "$BIN" ]; then
+        echo "$BIN is missing, run make all tools first" >&2
+        exit 1
+    fi
+done
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+cd "$WORK" || exit 1
+
+# Runs command.txt, sets SECONDS_TAKEN and PEAK_RSS
+measure() {
+    local result
+    result=$(env $1 "$MEASURE" "$RUN")
+    SECONDS_TAKEN=${result% *}
+    PEAK_RSS=${result#* }
+}
+
+# bench_graph <backend> <env> <model> <file> <vertices> <edges>
+bench_graph() {
+    local backend=$1 envs=$2 model=$3 file=$4 v=$5 e=$6
+    local commands=("PRINT" "BFS O 0" "DFS O 0" "DIJKSTRA O 0" "KRUSKAL" "BELLMANFORD O 0 $((v - 1))")
+    if [ "$v" -le "$APSP_MAX" ]; then
+        commands+=("FLOYD O" "CENTRALITY")
+    fi
+
+    printf 'LOAD %s\nEXIT\n' "$file" > command.txt
+    measure "$envs"
+    local load=$SECONDS_TAKEN
+    row "$backend" "$model" "$v" "$e" "LOAD" "$load" "$PEAK_RSS"
+
+    local cmd
+    for cmd in "${commands[@]}"; do
+        printf 'LOAD %s\n%s\nEXIT\n' "$file" "$cmd" > command.txt
+        measure "$envs"
+        row "$backend" "$model" "$v" "$e" "$cmd" \
+            "$(awk -v a="$SECONDS_TAKEN" -v b="$load" 'BEGIN { d = a - b; printf "%.6f", (d > 0 ? d : 0) }')" "$PEAK_RSS"
+    done
+}
+
+# row <backend> <model> <vertices> <edges> <command> <seconds> <rss>
+row() {
+    awk -v b="$1" -v m="$2" -v v="$3" -v e="$4" -v c="$5" -v s="$6" -v r="$7" \
+        'BEGIN { printf "%s,%s,%s,%s,%s,%.6f,%.0f,%s\n", b, m, v, e, c, s, (s > 0 ? e / s : 0), r }' >> "$OUT"
+    echo "$1 $2 V=$3 $5: $6 s" >&2
+}
+
+# gen <model> <vertices> <edges> <format> <file>, prints the edge count written
+gen() {
+    "$GEN" -t "$1" -v "$2" -e "$3" -f "$4" -o "$5" 2>&1 | sed -n 's/.* E=\([0-9]*\) .*/\1/p'
+}
+
+echo "backend,model,vertices,edges,command,seconds,edges_per_sec,peak_rss_kb" > "$OUT"
+
+for V in $SCALES; do
+    for MODEL in rmat grid; do
+        E=$(gen "$MODEL" "$V" $((V * DEGREE)) L graph.txt)
+        gen "$MODEL" "$V" $((V * DEGREE)) B graph.bin > /dev/null
+        bench_graph list "" "$MODEL" graph.txt "$V" "$E"
+        bench_graph csr "DS_GRAPH_BACKEND=csr" "$MODEL" graph.txt "$V" "$E"
+        bench_graph snapshot "" "$MODEL" graph.bin "$V" "$E"
+    done
+done
+
+for V in $MATRIX_SCALES; do
+    E=$(gen er "$V" $((V * V / 10)) M graph.txt)
+    bench_graph matrix "" er graph.txt "$V" "$E"
+done
+
+echo "results in $OUT" >&2
@@ -0,0 +1,101 @@
+#!/bin/bash
+# Parallel clients against `run --socket`: FLOYD / CENTRALITY / BFS / KRUSKAL next to the
+# *_BATCH commands, all of them using the thread pool at once.
+# usage: bench/server_concurrency.sh [rounds]          (make servercheck)
+# Environment:
+#   CHECK_VERTICES  vertex count of the generated graph (default 700)
+#   CHECK_THREADS   DS_THREADS of the server            (default 4)
+#   CHECK_TIMEOUT   seconds a round may take            (default 120)
+# Every client's responses must match the same commands run alone through `run --stdin`.
+# Exits 1 when a round hangs or any response differs.
+
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+RUN=$ROOT/run
+GEN=$ROOT/tools/gengraph
+CLIENT=$ROOT/tools/dsclient
+
+ROUNDS=${1:-3}
+V=${CHECK_VERTICES:-700}
+THREADS=${CHECK_THREADS:-4}
+LIMIT=${CHECK_TIMEOUT:-120}
+
+for BIN in "$RUN" "$GEN" "$CLIENT"; do
+    if [ ! -x "$BIN" ]; then
+        echo "$BIN is missing, run make all tools first" >&2
+        exit 1
+    fi
+done
+
+WORK=$(mktemp -d)
+SERVER=
+cleanup() {
+    [ -n "$SERVER" ] && kill "$SERVER" 2> /dev/null
+    rm -rf "$WORK"
+}
+trap cleanup EXIT
+cd "$WORK" || exit 1
+
+"$GEN" -t er -v "$V" -e $((V * 8)) -s 7 -o graph.txt || exit 1
+
+# Client scripts, LOAD is sent once by the setup client
+pairs() {
+    local i
+    for i in $(seq 0 $(($1 - 1))); do
+        printf ' %d %d' $(((i * 37) % V)) $(((i * 101 + 13) % V))
+    done
+}
+printf 'FLOYD O\nCENTRALITY\nFLOYD X\n' > apsp.txt
+printf 'CENTRALITY\nFLOYD O\n' > apsp2.txt
+printf 'BELLMANFORD_BATCH O%s\n' "$(pairs 400)" > bf.txt
+printf 'BELLMANFORD_BATCH X%s\n' "$(pairs 400)" > bfx.txt
+printf 'DIJKSTRA_BATCH O%s\n' "$(seq -s ' ' 0 3 $((V - 1)))" > dj.txt
+printf 'BFS O 0\nREACH X 1\nKRUSKAL\nPATH O 0 %d\nBELLMANFORD X 2 %d\nDFS O 3\n' $((V - 1)) $((V / 2)) > mix.txt
+CLIENTS="apsp apsp2 bf bf bfx dj mix mix"
+
+# Expected responses: each script alone, without its LOAD block
+for NAME in $(echo $CLIENTS | tr ' ' '\n' | sort -u); do
+    { echo "LOAD graph.txt"; cat "$NAME.txt"; } | DS_THREADS=$THREADS "$RUN" --stdin | tail -n +5 > "$NAME.expected"
+done
+
+DS_THREADS=$THREADS "$RUN" --socket "$WORK/ds.sock" 2> server.err &
+SERVER=$!
+for i in $(seq 50); do
+    [ -S "$WORK/ds.sock" ] && break
+    sleep 0.1
+done
+echo "LOAD graph.txt" | "$CLIENT" "$WORK/ds.sock" > load.out
+if ! grep -q Success load.out; then
+    echo "server did not load the graph" >&2
+    exit 1
+fi
+
+FAILED=0
+for ROUND in $(seq "$ROUNDS"); do
+    PIDS=
+    N=0
+    for NAME in $CLIENTS; do
+        timeout "$LIMIT" "$CLIENT" "$WORK/ds.sock" "$NAME.txt" > "out.$N.$NAME" &
+        PIDS="$PIDS $!"
+        N=$((N + 1))
+    done
+
+    STATUS=ok
+    for PID in $PIDS; do
+        wait "$PID" || STATUS=hung
+    done
+    if [ "$STATUS" = ok ]; then
+        for OUT in out.*; do
+            NAME=${OUT##*.}
+            cmp -s "$OUT" "$NAME.expected" || { STATUS="mismatch ($NAME)"; break; }
+        done
+    fi
+    rm -f out.*
+
+    echo "round $ROUND: $STATUS"
+    if [ "$STATUS" != ok ]; then
+        FAILED=1
+        break
+    fi
+done
+
+exit $FAILED
@@ -1,9 +1,27 @@
 #include "Manager.h"
+#include "Server.h"
+#include <cstring>
 #include <iomanip>
 
-int main()
+int main(int argc, char *argv[])
 {
+	// Server modes keep the graph loaded and answer commands until stopped
+	if (argc >= 2 && strcmp(argv[1], "--stdin") == 0)
+	{
+		Manager ds(nullptr);
+		CommandServer server(ds);
+		return server.serveStdin() ? 0 : 1;
+	}
+	if (argc >= 3 && strcmp(argv[1], "--socket") == 0)
+	{
+		Manager ds(nullptr);
+		CommandServer server(ds);
+		server.listenUnix(argv[2]);
+		cerr << "cannot listen on " << argv[2] << endl;
+		return 1;
+	}
+
 	Manager ds;	//Declare DS
 	ds.run("command.txt");	//Run Program
 	return 0;	//Return Program
-}
\ No newline at end of file
+}
@@ -0,0 +1,100 @@
+// Sends commands to a `run --socket` server and copies its responses to stdout.
+// usage: dsclient <socket path> [command file]
+// Commands come from the file or stdin. The write side is shut down after the last
+// command, so the server answers everything sent and then closes the connection.
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <csignal>
+#include <thread>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+// Writes all of data, false when the peer is gone
+static bool writeAll(int fd, const char *data, size_t length)
+{
+    while (length > 0)
+    {
+        ssize_t put = write(fd, data, length);
+        if (put < 0 && errno == EINTR)
+            continue;
+        if (put <= 0)
+            return false;
+        data += put;
+        length -= put;
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: dsclient <socket path> [command file]\n");
+        return 1;
+    }
+
+    int in = STDIN_FILENO;
+    if (argc >= 3 && (in = open(argv[2], O_RDONLY)) < 0)
+    {
+        perror(argv[2]);
+        return 1;
+    }
+
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(argv[1]) >= sizeof(addr.sun_path))
+    {
+        fprintf(stderr, "%s: socket path too long\n", argv[1]);
+        return 1;
+    }
+    strcpy(addr.sun_path, argv[1]);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, (sockaddr *)&addr, sizeof(addr)) < 0)
+    {
+        perror(argv[1]);
+        return 1;
+    }
+
+    // Requests go out on their own thread: the server stops reading while its
+    // responses wait for us, so sending everything first could block both sides.
+    // After EXIT the server hangs up, the rest of the input is dropped.
+    signal(SIGPIPE, SIG_IGN);
+    std::thread sender([&]
+    {
+        static char request[1 << 16];
+        ssize_t got;
+        while ((got = read(in, request, sizeof(request))) > 0 && writeAll(fd, request, got))
+        {
+        }
+        shutdown(fd, SHUT_WR);
+    });
+
+    static char buffer[1 << 16];
+    ssize_t got;
+    bool ok = true;
+    while ((got = read(fd, buffer, sizeof(buffer))) != 0)
+    {
+        if (got < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            perror("read");
+            ok = false;
+            break;
+        }
+        if (!writeAll(STDOUT_FILENO, buffer, got))
+        {
+            ok = false;
+            break;
+        }
+    }
+    sender.join();
+
+    close(fd);
+    return ok ? 0 : 1;
+}
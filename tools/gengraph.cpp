@@ -0,0 +1,314 @@
+// Synthetic graph generator for benchmarks.
+// usage: gengraph -t rmat|grid|er|dag -v V [-e E] [-w min:max] [-n ratio] [-s seed] [-f L|M|B] -o file
+//   -e  target edge count (grid: extra local shortcuts beyond the grid itself)
+//   -w  weight magnitude range, 1 <= min <= max (default 1:100)
+//   -n  fraction of edges that get a negative weight (default 0)
+//   -f  L / M text as LOAD reads them, or B for a SAVE snapshot
+#include "Graph.h"
+#include "CsrGraph.h"
+#include "GraphSnapshot.h"
+#include "LogSink.h"
+#include <random>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <unistd.h>
+
+using namespace std;
+
+// Rounds of sampling before giving up on reaching the edge target
+static const int MAX_ROUNDS = 64;
+
+struct Options
+{
+    string model;
+    int vertices;
+    long long edges;
+    int minWeight;
+    int maxWeight;
+    double negative;
+    unsigned long long seed;
+    char format;
+    string output;
+};
+
+static void usage()
+{
+    fprintf(stderr, "usage: gengraph -t rmat|grid|er|dag -v V [-e E] [-w min:max] [-n ratio] [-s seed] [-f L|M|B] -o file\n");
+    exit(1);
+}
+
+// Edge key from, to packed as from * V + to, so sorting keys sorts by (from, to)
+typedef long long EdgeKey;
+
+// Sort, drop duplicates, keep at most target keys
+static void settle(vector<EdgeKey> &keys, long long target)
+{
+    sort(keys.begin(), keys.end());
+    keys.erase(unique(keys.begin(), keys.end()), keys.end());
+    if ((long long)keys.size() > target)
+    {
+        keys.resize(target);
+    }
+}
+
+// Draw candidates from sample until target distinct keys exist (or MAX_ROUNDS pass)
+template <class Sample>
+static void sampleEdges(vector<EdgeKey> &keys, long long target, Sample sample)
+{
+    for (int round = 0; round < MAX_ROUNDS && (long long)keys.size() < target; round++)
+    {
+        long long missing = target - (long long)keys.size();
+        for (long long i = 0; i < missing; i++)
+        {
+            keys.push_back(sample());
+        }
+        settle(keys, target);
+    }
+}
+
+// Uniform pairs u != v
+static void erdosRenyi(const Options &opt, mt19937_64 &rng, vector<EdgeKey> &keys)
+{
+    long long n = opt.vertices;
+    uniform_int_distribution<long long> pick(0, n - 1);
+    sampleEdges(keys, min(opt.edges, n * (n - 1)), [&]()
+    {
+        long long u = pick(rng), v = pick(rng);
+        while (v == u)
+            v = pick(rng);
+        return u * n + v;
+    });
+}
+
+// Recursive matrix (a, b, c, d) = (0.57, 0.19, 0.19, 0.05), power-law degrees
+static void rmat(const Options &opt, mt19937_64 &rng, vector<EdgeKey> &keys)
+{
+    long long n = opt.vertices;
+    int scale = 0;
+    while ((1LL << scale) < n)
+        scale++;
+
+    uniform_real_distribution<double> coin(0.0, 1.0);
+    sampleEdges(keys, min(opt.edges, n * (n - 1)), [&]()
+    {
+        while (true)
+        {
+            long long u = 0, v = 0;
+            for (int bit = 0; bit < scale; bit++)
+            {
+                double r = coin(rng);
+                u = u * 2 + (r >= 0.76);
+                v = v * 2 + ((r >= 0.57 && r < 0.76) || r >= 0.95);
+            }
+            if (u < n && v < n && u != v)
+                return u * n + v;
+        }
+    });
+}
+
+// 4-neighbour grid in both directions, extra edges are short local links (road-like)
+static void grid(const Options &opt, mt19937_64 &rng, vector<EdgeKey> &keys)
+{
+    long long n = opt.vertices;
+    long long cols = (long long)ceil(sqrt((double)n));
+
+    for (long long v = 0; v < n; v++)
+    {
+        long long right = v + 1, down = v + cols;
+        if (right % cols != 0 && right < n)
+        {
+            keys.push_back(v * n + right);
+            keys.push_back(right * n + v);
+        }
+        if (down < n)
+        {
+            keys.push_back(v * n + down);
+            keys.push_back(down * n + v);
+        }
+    }
+    settle(keys, n * n);
+
+    uniform_int_distribution<long long> pick(0, n - 1);
+    uniform_int_distribution<long long> step(-3, 3);
+    sampleEdges(keys, min(opt.edges, n * (n - 1)), [&]()
+    {
+        while (true)
+        {
+            long long u = pick(rng);
+            long long v = u + step(rng) * cols + step(rng);
+            if (v >= 0 && v < n && v != u)
+                return u * n + v;
+        }
+    });
+}
+
+// Edges always go from lower to higher rank of a random vertex order
+static void dag(const Options &opt, mt19937_64 &rng, vector<EdgeKey> &keys)
+{
+    long long n = opt.vertices;
+    vector<int> rank(n);
+    for (int v = 0; v < n; v++)
+        rank[v] = v;
+    shuffle(rank.begin(), rank.end(), rng);
+
+    uniform_int_distribution<long long> pick(0, n - 1);
+    sampleEdges(keys, min(opt.edges, n * (n - 1) / 2), [&]()
+    {
+        long long u = pick(rng), v = pick(rng);
+        while (v == u)
+            v = pick(rng);
+        if (rank[u] > rank[v])
+            swap(u, v);
+        return u * n + v;
+    });
+}
+
+static bool writeList(const Options &opt, const vector<EdgeKey> &keys, const vector<int> &weight)
+{
+    LogSink out;
+    if (!out.open(opt.output.c_str()))
+        return false;
+
+    out << "L " << opt.vertices << "\n";
+    size_t e = 0;
+    for (long long u = 0; u < opt.vertices; u++)
+    {
+        out << u << "\n";
+        for (; e < keys.size() && keys[e] / opt.vertices == u; e++)
+        {
+            out << (int)(keys[e] % opt.vertices) << " " << weight[e] << "\n";
+        }
+    }
+    return true;
+}
+
+static bool writeMatrix(const Options &opt, const vector<EdgeKey> &keys, const vector<int> &weight)
+{
+    LogSink out;
+    if (!out.open(opt.output.c_str()))
+        return false;
+
+    out << "M " << opt.vertices << "\n";
+    size_t e = 0;
+    for (long long u = 0; u < opt.vertices; u++)
+    {
+        for (long long v = 0; v < opt.vertices; v++)
+        {
+            int w = 0;
+            if (e < keys.size() && keys[e] == u * opt.vertices + v)
+                w = weight[e++];
+            out << w << (v + 1 < opt.vertices ? " " : "\n");
+        }
+    }
+    return true;
+}
+
+static bool writeSnapshot(const Options &opt, const vector<EdgeKey> &keys, const vector<int> &weight)
+{
+    vector<int> from(keys.size()), to(keys.size());
+    for (size_t e = 0; e < keys.size(); e++)
+    {
+        from[e] = (int)(keys[e] / opt.vertices);
+        to[e] = (int)(keys[e] % opt.vertices);
+    }
+    CsrGraph graph(true, opt.vertices, from, to, weight);
+    return saveSnapshot(&graph, opt.output.c_str());
+}
+
+int main(int argc, char **argv)
+{
+    Options opt;
+    opt.vertices = 0;
+    opt.edges = 0;
+    opt.minWeight = 1;
+    opt.maxWeight = 100;
+    opt.negative = 0;
+    opt.seed = 1;
+    opt.format = 'L';
+
+    int c;
+    while ((c = getopt(argc, argv, "t:v:e:w:n:s:f:o:")) != -1)
+    {
+        switch (c)
+        {
+        case 't':
+            opt.model = optarg;
+            break;
+        case 'v':
+            opt.vertices = atoi(optarg);
+            break;
+        case 'e':
+            opt.edges = atoll(optarg);
+            break;
+        case 'w':
+            if (sscanf(optarg, "%d:%d", &opt.minWeight, &opt.maxWeight) != 2)
+                usage();
+            break;
+        case 'n':
+            opt.negative = atof(optarg);
+            break;
+        case 's':
+            opt.seed = strtoull(optarg, nullptr, 10);
+            break;
+        case 'f':
+            opt.format = optarg[0];
+            break;
+        case 'o':
+            opt.output = optarg;
+            break;
+        default:
+            usage();
+        }
+    }
+
+    if (opt.vertices <= 0 || opt.output.empty() || opt.minWeight < 1 || opt.maxWeight < opt.minWeight ||
+        opt.negative < 0 || opt.negative > 1 || (opt.format != 'L' && opt.format != 'M' && opt.format != 'B'))
+    {
+        usage();
+    }
+
+    mt19937_64 rng(opt.seed);
+    vector<EdgeKey> keys;
+    if (opt.model == "er")
+        erdosRenyi(opt, rng, keys);
+    else if (opt.model == "rmat")
+        rmat(opt, rng, keys);
+    else if (opt.model == "grid")
+        grid(opt, rng, keys);
+    else if (opt.model == "dag")
+        dag(opt, rng, keys);
+    else
+        usage();
+
+    // Weights never 0, which M files cannot tell apart from no edge
+    uniform_int_distribution<int> magnitude(opt.minWeight, opt.maxWeight);
+    bernoulli_distribution negative(opt.negative);
+    vector<int> weight(keys.size());
+    for (size_t e = 0; e < keys.size(); e++)
+    {
+        weight[e] = magnitude(rng);
+        if (negative(rng))
+            weight[e] = -weight[e];
+    }
+
+    bool ok;
+    if (opt.format == 'L')
+        ok = writeList(opt, keys, weight);
+    else if (opt.format == 'M')
+        ok = writeMatrix(opt, keys, weight);
+    else
+        ok = writeSnapshot(opt, keys, weight);
+
+    if (!ok)
+    {
+        fprintf(stderr, "gengraph: cannot write %s\n", opt.output.c_str());
+        return 1;
+    }
+
+    fprintf(stderr, "%s V=%d E=%zu -> %s\n", opt.model.c_str(), opt.vertices, keys.size(), opt.output.c_str());
+    return 0;
+}